@@ -160,10 +160,14 @@ block_type (struct block *block)
   return block->type;
 }
 
-/* Prints statistics for each block device used for a Pintos role. */
+/* Prints statistics for each block device used for a Pintos role,
+   then for any additional swap device that has seen I/O.  Raw
+   devices are left out, since I/O to their partitions is counted
+   against them too. */
 void
 block_print_stats (void)
 {
+  struct list_elem *e;
   int i;
 
   for (i = 0; i < BLOCK_ROLE_CNT; i++)
@@ -176,6 +180,17 @@ block_print_stats (void)
                   block->read_cnt, block->write_cnt);
         }
     }
+
+  for (e = list_begin (&all_blocks); e != list_end (&all_blocks);
+       e = list_next (e))
+    {
+      struct block *block = list_entry (e, struct block, list_elem);
+      if (block->type == BLOCK_SWAP && block_by_role[BLOCK_SWAP] != block
+          && (block->read_cnt > 0 || block->write_cnt > 0))
+        printf ("%s (%s): %llu reads, %llu writes\n",
+                block->name, block_type_name (block->type),
+                block->read_cnt, block->write_cnt);
+    }
 }
 
 /* Registers a new block device with the given NAME.  If
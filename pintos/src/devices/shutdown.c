@@ -12,6 +12,10 @@
 #ifdef FILESYS
 #include "devices/block.h"
 #include "filesys/filesys.h"
+#include "filesys/fsstat.h"
+#endif
+#ifdef VM
+#include "vm/vmstat.h"
 #endif
 
 /* Keyboard control register port. */
@@ -129,10 +133,14 @@ print_stats (void)
   thread_print_stats ();
 #ifdef FILESYS
   block_print_stats ();
+  fsstat_print_stats ();
 #endif
   console_print_stats ();
   kbd_print_stats ();
 #ifdef USERPROG
   exception_print_stats ();
 #endif
+#ifdef VM
+  vmstat_print_stats ();
+#endif
 }
@@ -182,11 +182,7 @@ timer_interrupt (struct intr_frame *args UNUSED)
   check_blocked_list ();	// IMTC
 
 #ifdef VM
-  if (ticks % (TIMER_FREQ * 10) == 0)	// IMTC
-    check_frame_accessed_recently ();	// IMTC
-
-  if (ticks % (TIMER_FREQ * 100) == 0)  // IMTC
-    sort_frame_table ();		// IMTC
+  frame_table_tick ();			// IMTC
 
   if (ticks % (TIMER_FREQ * 1000) == 0)	// IMTC
     wake_up_error ();			// IMTC
@@ -37,7 +37,10 @@ main (int argc, char *argv[])
       return EXIT_FAILURE;
     }
 
-  /* Copy data. */
+  /* Copy data inside the kernel if it can, otherwise through
+     a buffer. */
+  while (copy_file_range (in_fd, -1, out_fd, -1, 64 * 1024) > 0)
+    continue;
   for (;;) 
     {
       char buffer[1024];
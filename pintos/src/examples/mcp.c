@@ -1,6 +1,7 @@
 /* mcp.c
 
-   Copies one file to another, using mmap. */
+   Copies one file to another, inside the kernel if possible,
+   otherwise using mmap. */
 
 #include <stdio.h>
 #include <string.h>
@@ -43,6 +44,10 @@ main (int argc, char *argv[])
       return EXIT_FAILURE;
     }
 
+  /* Copy files without mapping them, if the kernel can. */
+  if (copy_file_range (in_fd, 0, out_fd, 0, size) == size)
+    return EXIT_SUCCESS;
+
   /* Map files. */
   in_map = mmap (in_fd, in_data);
   if (in_map == MAP_FAILED) 
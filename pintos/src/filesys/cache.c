@@ -0,0 +1,522 @@
+#include <hash.h>
+#include <string.h>
+#include <debug.h>
+#include "filesys/cache.h"
+#include "filesys/filesys.h"
+#include "filesys/fsstat.h"
+#include "filesys/inode.h"
+#include "devices/timer.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+/* Most sectors waiting to be read ahead.  Requests beyond this
+   are dropped, since read-ahead is only a hint. */
+#define READ_AHEAD_QUEUE 64
+
+/* How often the flusher thread wakes up, in timer ticks. */
+#define FLUSH_INTERVAL (TIMER_FREQ / 10)
+
+/* Most dirty sectors allowed in the cache.  A write that leaves
+   more than this many dirty writes them all back itself, instead
+   of leaving it to the flusher thread. */
+#define DIRTY_MAX (CACHE_SIZE * 3 / 4)
+
+/* A cached copy of one sector of the file system device.
+
+   SECTOR, VALID, PIN_CNT and the hash element are protected by
+   cache_lock.  DATA and DIRTY are protected by LOCK, which is
+   only taken by a thread that has pinned the entry, so an
+   unpinned entry's lock is always free. */
+struct cache_entry
+  {
+    block_sector_t sector;              /* Cached sector. */
+    bool valid;                         /* In the hash and in use? */
+    bool loaded;                        /* DATA read from disk? */
+    bool dirty;                         /* DATA newer than disk? */
+    bool accessed;                      /* Used since the clock hand passed? */
+    int64_t dirty_time;                 /* Timer tick when DIRTY was set. */
+    int pin_cnt;                        /* Threads using this entry. */
+    struct lock lock;                   /* Protects DATA. */
+    struct hash_elem elem;              /* Element in cache_map. */
+    uint8_t data[BLOCK_SECTOR_SIZE];    /* Sector contents. */
+  };
+
+static struct cache_entry cache[CACHE_SIZE];
+static struct hash cache_map;
+static struct lock cache_lock;
+static int clock_hand;
+
+/* Number of dirty entries, protected by cache_lock. */
+static int dirty_cnt;
+
+/* Sectors dirty for at least this many milliseconds are written
+   back by the flusher thread. */
+static int flush_age_ms = 1000;
+
+/* Sectors queued for the read-ahead thread, as a ring buffer
+   protected by ra_lock. */
+static block_sector_t ra_queue[READ_AHEAD_QUEUE];
+static int ra_head, ra_cnt;
+static struct lock ra_lock;
+static struct condition ra_cond;
+
+static unsigned cache_hash (const struct hash_elem *, void *);
+static bool cache_less (const struct hash_elem *, const struct hash_elem *,
+                        void *);
+static struct cache_entry *cache_get (block_sector_t, bool load, bool *hit);
+static void cache_put (struct cache_entry *, bool dirty);
+static struct cache_entry *cache_lookup (block_sector_t);
+static struct cache_entry *cache_evict (void);
+static void write_back (int64_t deadline, block_sector_t start,
+                        block_sector_t end);
+static void read_ahead_daemon (void *);
+static void flush_daemon (void *);
+static void count_lookup (bool hit);
+static void device_read (block_sector_t, void *);
+static void device_write (block_sector_t, const void *);
+
+/* Initializes the buffer cache. */
+void
+cache_init (void)
+{
+  int i;
+
+  lock_init (&cache_lock);
+  hash_init (&cache_map, cache_hash, cache_less, NULL);
+  for (i = 0; i < CACHE_SIZE; i++)
+  {
+    cache[i].valid = false;
+    cache[i].pin_cnt = 0;
+    lock_init (&cache[i].lock);
+  }
+  clock_hand = 0;
+  dirty_cnt = 0;
+
+  lock_init (&ra_lock);
+  cond_init (&ra_cond);
+  ra_head = ra_cnt = 0;
+  thread_create ("read-ahead", PRI_DEFAULT, read_ahead_daemon, NULL);
+  thread_create ("flusher", PRI_DEFAULT, flush_daemon, NULL);
+}
+
+/* Sets the age, in milliseconds, at which the flusher thread
+   writes dirty sectors back to disk. */
+void
+cache_set_flush_age (int ms)
+{
+  flush_age_ms = ms;
+}
+
+/* Reads SIZE bytes starting at SECTOR_OFS within SECTOR into
+   BUFFER, going to disk only if SECTOR is not cached.
+   Returns true if SECTOR was cached. */
+bool
+cache_read (block_sector_t sector, void *buffer, int sector_ofs, size_t size)
+{
+  struct cache_entry *e;
+  bool hit;
+
+  ASSERT (sector_ofs >= 0 && sector_ofs + size <= BLOCK_SECTOR_SIZE);
+
+  e = cache_get (sector, true, &hit);
+  memcpy (buffer, e->data + sector_ofs, size);
+  cache_put (e, false);
+
+  count_lookup (hit);
+  return hit;
+}
+
+/* Writes SIZE bytes from BUFFER into SECTOR starting at
+   SECTOR_OFS.  The sector is only read from disk first if the
+   write does not cover all of it, and is written back later by
+   the flusher thread, unless too much of the cache is dirty.
+   Returns true if SECTOR was cached. */
+bool
+cache_write (block_sector_t sector, const void *buffer, int sector_ofs,
+             size_t size)
+{
+  struct cache_entry *e;
+  bool hit;
+
+  ASSERT (sector_ofs >= 0 && sector_ofs + size <= BLOCK_SECTOR_SIZE);
+
+  e = cache_get (sector, size < BLOCK_SECTOR_SIZE, &hit);
+  memcpy (e->data + sector_ofs, buffer, size);
+  e->loaded = true;
+  cache_put (e, true);
+
+  if (dirty_cnt > DIRTY_MAX)
+    write_back (timer_ticks (), 0, UINT32_MAX);
+
+  count_lookup (hit);
+  return hit;
+}
+
+/* Reads all of SECTOR into BUFFER without bringing it into the
+   cache.  A cached copy is used if there is one, since it may be
+   newer than the disk. */
+void
+cache_read_direct (block_sector_t sector, void *buffer)
+{
+  struct cache_entry *e;
+
+  lock_acquire (&cache_lock);
+  e = cache_lookup (sector);
+  if (e == NULL)
+  {
+    lock_release (&cache_lock);
+    device_read (sector, buffer);
+    return;
+  }
+  e->pin_cnt++;
+  lock_release (&cache_lock);
+
+  lock_acquire (&e->lock);
+  if (!e->loaded)
+  {
+    device_read (sector, e->data);
+    e->loaded = true;
+  }
+  memcpy (buffer, e->data, BLOCK_SECTOR_SIZE);
+  cache_put (e, false);
+}
+
+/* Writes all of SECTOR from BUFFER straight to disk, without
+   bringing it into the cache.  A cached copy is updated and
+   written through instead. */
+void
+cache_write_direct (block_sector_t sector, const void *buffer)
+{
+  struct cache_entry *e;
+  bool cleaned;
+
+  lock_acquire (&cache_lock);
+  e = cache_lookup (sector);
+  if (e == NULL)
+  {
+    /* Write under cache_lock, as cache_evict() does, so that no
+       other thread can read the old contents into the cache
+       before the new ones reach the disk. */
+    device_write (sector, buffer);
+    lock_release (&cache_lock);
+    return;
+  }
+  e->pin_cnt++;
+  lock_release (&cache_lock);
+
+  lock_acquire (&e->lock);
+  memcpy (e->data, buffer, BLOCK_SECTOR_SIZE);
+  e->loaded = true;
+  device_write (sector, e->data);
+  cleaned = e->dirty;
+  e->dirty = false;
+  lock_release (&e->lock);
+
+  lock_acquire (&cache_lock);
+  e->pin_cnt--;
+  if (cleaned)
+    dirty_cnt--;
+  lock_release (&cache_lock);
+}
+
+/* Writes every dirty sector back to disk. */
+void
+cache_flush (void)
+{
+  write_back (INT64_MAX, 0, UINT32_MAX);
+}
+
+/* Writes the dirty sectors among the CNT sectors starting at
+   START back to disk. */
+void
+cache_flush_range (block_sector_t start, size_t cnt)
+{
+  write_back (INT64_MAX, start, start + cnt);
+}
+
+/* Asks the read-ahead thread to bring SECTOR into the cache.
+   Does not wait for it.  Returns false, dropping the request,
+   if too many are already queued. */
+bool
+cache_read_ahead (block_sector_t sector)
+{
+  bool queued = false;
+
+  lock_acquire (&ra_lock);
+  if (ra_cnt < READ_AHEAD_QUEUE)
+  {
+    ra_queue[(ra_head + ra_cnt++) % READ_AHEAD_QUEUE] = sector;
+    cond_signal (&ra_cond, &ra_lock);
+    queued = true;
+  }
+  lock_release (&ra_lock);
+
+  return queued;
+}
+
+/* Reads queued sectors into the cache, one at a time, so that
+   processes reading sequentially find them already there. */
+static void
+read_ahead_daemon (void *aux UNUSED)
+{
+  for (;;)
+  {
+    block_sector_t sector;
+    struct cache_entry *e;
+    bool cached;
+
+    lock_acquire (&ra_lock);
+    while (ra_cnt == 0)
+      cond_wait (&ra_cond, &ra_lock);
+    sector = ra_queue[ra_head];
+    ra_head = (ra_head + 1) % READ_AHEAD_QUEUE;
+    ra_cnt--;
+    lock_release (&ra_lock);
+
+    lock_acquire (&cache_lock);
+    cached = cache_lookup (sector) != NULL;
+    lock_release (&cache_lock);
+    if (cached)
+      continue;
+
+    /* Leave the accessed bit clear, so that a sector nobody ends
+       up reading is the first to go. */
+    e = cache_get (sector, true, NULL);
+    lock_release (&e->lock);
+    lock_acquire (&cache_lock);
+    e->pin_cnt--;
+    lock_release (&cache_lock);
+  }
+}
+
+/* Writes back sectors that have been dirty for longer than the
+   flush age, so that dirty data neither piles up in the cache
+   nor waits long to reach the disk.  Files' tail buffers, which
+   hold appended data that has not reached the cache yet, are
+   written back on the same schedule. */
+static void
+flush_daemon (void *aux UNUSED)
+{
+  for (;;)
+  {
+    int64_t deadline;
+
+    timer_sleep (FLUSH_INTERVAL);
+    deadline = timer_ticks () - (int64_t) flush_age_ms * TIMER_FREQ / 1000;
+    inode_flush_tails (deadline);
+    write_back (deadline, 0, UINT32_MAX);
+  }
+}
+
+/* Writes back every cached sector from START up to but not
+   including END that has been dirty since tick DEADLINE or
+   earlier.  The sectors are written in ascending order, so that
+   adjacent dirty sectors go to disk back to back. */
+static void
+write_back (int64_t deadline, block_sector_t start, block_sector_t end)
+{
+  struct cache_entry *batch[CACHE_SIZE];
+  int cnt = 0;
+  int i, j;
+
+  /* Pin the entries to write, sorted by sector. */
+  lock_acquire (&cache_lock);
+  for (i = 0; i < CACHE_SIZE; i++)
+  {
+    struct cache_entry *e = &cache[i];
+
+    if (!e->valid || !e->dirty || e->dirty_time > deadline
+        || e->sector < start || e->sector >= end)
+      continue;
+    e->pin_cnt++;
+    for (j = cnt++; j > 0 && batch[j - 1]->sector > e->sector; j--)
+      batch[j] = batch[j - 1];
+    batch[j] = e;
+  }
+  lock_release (&cache_lock);
+
+  for (i = 0; i < cnt; i++)
+  {
+    struct cache_entry *e = batch[i];
+    bool cleaned = false;
+
+    lock_acquire (&e->lock);
+    if (e->dirty)
+    {
+      device_write (e->sector, e->data);
+      e->dirty = false;
+      cleaned = true;
+    }
+    lock_release (&e->lock);
+
+    lock_acquire (&cache_lock);
+    e->pin_cnt--;
+    if (cleaned)
+      dirty_cnt--;
+    lock_release (&cache_lock);
+  }
+}
+
+/* Returns the entry for SECTOR, pinned and with its lock held,
+   evicting another sector if necessary.  If LOAD is true the
+   entry's data is read from disk if it is not already there;
+   otherwise the caller must overwrite all of it.  If HIT is
+   non-null, sets *HIT to whether SECTOR was already cached. */
+static struct cache_entry *
+cache_get (block_sector_t sector, bool load, bool *hit)
+{
+  struct cache_entry *e;
+
+  lock_acquire (&cache_lock);
+  e = cache_lookup (sector);
+  if (hit != NULL)
+    *hit = e != NULL;
+  if (e == NULL)
+  {
+    e = cache_evict ();
+    e->sector = sector;
+    e->valid = true;
+    e->loaded = false;
+    e->dirty = false;
+    hash_insert (&cache_map, &e->elem);
+  }
+  e->pin_cnt++;
+  lock_release (&cache_lock);
+
+  lock_acquire (&e->lock);
+  if (load && !e->loaded)
+  {
+    device_read (sector, e->data);
+    e->loaded = true;
+  }
+
+  return e;
+}
+
+/* Releases entry E obtained from cache_get(), marking it dirty
+   if DIRTY is true. */
+static void
+cache_put (struct cache_entry *e, bool dirty)
+{
+  bool newly_dirty = dirty && !e->dirty;
+
+  if (newly_dirty)
+  {
+    e->dirty = true;
+    e->dirty_time = timer_ticks ();
+  }
+  e->accessed = true;
+  lock_release (&e->lock);
+
+  lock_acquire (&cache_lock);
+  e->pin_cnt--;
+  if (newly_dirty)
+    dirty_cnt++;
+  lock_release (&cache_lock);
+}
+
+/* Returns the valid entry for SECTOR, or a null pointer if it is
+   not cached.  Must be called with cache_lock held. */
+static struct cache_entry *
+cache_lookup (block_sector_t sector)
+{
+  struct cache_entry key;
+  struct hash_elem *e;
+
+  key.sector = sector;
+  e = hash_find (&cache_map, &key.elem);
+
+  return e != NULL ? hash_entry (e, struct cache_entry, elem) : NULL;
+}
+
+/* Chooses an unpinned entry with the clock algorithm, writes it
+   back if it is dirty, and removes it from the cache.  Clean
+   entries are preferred on the first sweep, since the flusher
+   thread will soon clean the dirty ones anyway.  Must be
+   called with cache_lock held.  The write-back is done under
+   cache_lock so that no other thread can read the sector from
+   disk before its new contents reach it. */
+static struct cache_entry *
+cache_evict (void)
+{
+  struct cache_entry *e;
+
+  for (;;)
+  {
+    int i;
+
+    for (i = 0; i < 2 * CACHE_SIZE; i++)
+    {
+      e = &cache[clock_hand];
+      clock_hand = (clock_hand + 1) % CACHE_SIZE;
+
+      if (!e->valid)
+	return e;
+      if (e->pin_cnt > 0)
+	continue;
+      if (e->accessed)
+      {
+	e->accessed = false;
+	continue;
+      }
+      if (e->dirty && i < CACHE_SIZE)
+	continue;
+
+      if (e->dirty)
+      {
+	device_write (e->sector, e->data);
+	e->dirty = false;
+	dirty_cnt--;
+      }
+      hash_delete (&cache_map, &e->elem);
+      e->valid = false;
+      return e;
+    }
+
+    /* Every entry is pinned.  Let their users finish. */
+    lock_release (&cache_lock);
+    thread_yield ();
+    lock_acquire (&cache_lock);
+  }
+}
+
+/* Counts a cache lookup made by a read or write. */
+static void
+count_lookup (bool hit)
+{
+  fsstat_count (NULL, hit ? FSSTAT_CACHE_HITS : FSSTAT_CACHE_MISSES, 1);
+}
+
+/* Reads SECTOR from the file system device into BUFFER. */
+static void
+device_read (block_sector_t sector, void *buffer)
+{
+  block_read (fs_device, sector, buffer);
+  fsstat_count (NULL, FSSTAT_SECTORS_READ, 1);
+}
+
+/* Writes BUFFER to SECTOR of the file system device. */
+static void
+device_write (block_sector_t sector, const void *buffer)
+{
+  block_write (fs_device, sector, buffer);
+  fsstat_count (NULL, FSSTAT_SECTORS_WRITTEN, 1);
+}
+
+static unsigned
+cache_hash (const struct hash_elem *e_, void *aux UNUSED)
+{
+  const struct cache_entry *e = hash_entry (e_, struct cache_entry, elem);
+
+  return hash_int (e->sector);
+}
+
+static bool
+cache_less (const struct hash_elem *a_, const struct hash_elem *b_,
+            void *aux UNUSED)
+{
+  const struct cache_entry *a = hash_entry (a_, struct cache_entry, elem);
+  const struct cache_entry *b = hash_entry (b_, struct cache_entry, elem);
+
+  return a->sector < b->sector;
+}
@@ -0,0 +1,21 @@
+#ifndef FILESYS_CACHE_H
+#define FILESYS_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "devices/block.h"
+
+/* Number of sectors held in the buffer cache. */
+#define CACHE_SIZE 64
+
+void cache_init (void);
+void cache_set_flush_age (int ms);
+bool cache_read (block_sector_t, void *, int sector_ofs, size_t size);
+bool cache_write (block_sector_t, const void *, int sector_ofs, size_t size);
+void cache_flush (void);
+void cache_flush_range (block_sector_t, size_t cnt);
+bool cache_read_ahead (block_sector_t);
+void cache_read_direct (block_sector_t, void *);
+void cache_write_direct (block_sector_t, const void *);
+
+#endif /* filesys/cache.h */
@@ -0,0 +1,181 @@
+#include <hash.h>
+#include <list.h>
+#include <string.h>
+#include <debug.h>
+#include "filesys/dcache.h"
+#include "filesys/directory.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+
+/* A cached directory entry: NAME in the directory whose inode is
+   at PARENT names the inode at CHILD, or nothing at all if CHILD
+   is DCACHE_NEGATIVE. */
+struct dentry
+  {
+    block_sector_t parent;              /* Directory inode sector. */
+    char name[NAME_MAX + 1];            /* Name within PARENT. */
+    block_sector_t child;               /* Named inode, or DCACHE_NEGATIVE. */
+    struct hash_elem elem;              /* Element in dcache_map. */
+    struct list_elem lru_elem;          /* Element in lru_list. */
+  };
+
+static struct hash dcache_map;
+static struct list lru_list;            /* Most recently used first. */
+static struct lock dcache_lock;
+
+static unsigned dentry_hash (const struct hash_elem *, void *);
+static bool dentry_less (const struct hash_elem *, const struct hash_elem *,
+                         void *);
+static struct dentry *find (block_sector_t parent, const char *name);
+static void remove_dentry (struct dentry *);
+
+/* Initializes the directory entry cache. */
+void
+dcache_init (void)
+{
+  hash_init (&dcache_map, dentry_hash, dentry_less, NULL);
+  list_init (&lru_list);
+  lock_init (&dcache_lock);
+}
+
+/* Looks up NAME in the directory at PARENT.  On a hit, stores
+   the child's inode sector, or DCACHE_NEGATIVE if NAME is known
+   not to exist, into *CHILD and returns true.  Returns false if
+   the cache knows nothing about NAME. */
+bool
+dcache_lookup (block_sector_t parent, const char *name,
+               block_sector_t *child)
+{
+  struct dentry *d;
+
+  lock_acquire (&dcache_lock);
+  d = find (parent, name);
+  if (d != NULL)
+  {
+    *child = d->child;
+    list_remove (&d->lru_elem);
+    list_push_front (&lru_list, &d->lru_elem);
+  }
+  lock_release (&dcache_lock);
+
+  return d != NULL;
+}
+
+/* Records that NAME in the directory at PARENT names the inode
+   at CHILD, or nothing if CHILD is DCACHE_NEGATIVE.  Evicts the
+   least recently used name if the cache is full. */
+void
+dcache_insert (block_sector_t parent, const char *name,
+               block_sector_t child)
+{
+  struct dentry *d;
+
+  if (strlen (name) > NAME_MAX)
+    return;
+
+  lock_acquire (&dcache_lock);
+  d = find (parent, name);
+  if (d == NULL)
+  {
+    if (hash_size (&dcache_map) >= DCACHE_SIZE)
+      remove_dentry (list_entry (list_back (&lru_list), struct dentry,
+                                 lru_elem));
+
+    d = malloc (sizeof *d);
+    if (d == NULL)
+    {
+      lock_release (&dcache_lock);
+      return;
+    }
+    d->parent = parent;
+    strlcpy (d->name, name, sizeof d->name);
+    hash_insert (&dcache_map, &d->elem);
+  }
+  else
+    list_remove (&d->lru_elem);
+
+  d->child = child;
+  list_push_front (&lru_list, &d->lru_elem);
+  lock_release (&dcache_lock);
+}
+
+/* Forgets whatever is cached for NAME in the directory at
+   PARENT.  Called whenever that entry changes on disk. */
+void
+dcache_invalidate (block_sector_t parent, const char *name)
+{
+  struct dentry *d;
+
+  lock_acquire (&dcache_lock);
+  d = find (parent, name);
+  if (d != NULL)
+    remove_dentry (d);
+  lock_release (&dcache_lock);
+}
+
+/* Forgets every name cached for the directory at PARENT, whose
+   sector is being reused for a new directory. */
+void
+dcache_purge_dir (block_sector_t parent)
+{
+  struct list_elem *e, *next;
+
+  lock_acquire (&dcache_lock);
+  for (e = list_begin (&lru_list); e != list_end (&lru_list); e = next)
+  {
+    struct dentry *d = list_entry (e, struct dentry, lru_elem);
+
+    next = list_next (e);
+    if (d->parent == parent)
+      remove_dentry (d);
+  }
+  lock_release (&dcache_lock);
+}
+
+/* Returns the cached entry for NAME in PARENT, or a null
+   pointer.  Must be called with dcache_lock held. */
+static struct dentry *
+find (block_sector_t parent, const char *name)
+{
+  struct dentry key;
+  struct hash_elem *e;
+
+  if (strlen (name) > NAME_MAX)
+    return NULL;
+
+  key.parent = parent;
+  strlcpy (key.name, name, sizeof key.name);
+  e = hash_find (&dcache_map, &key.elem);
+
+  return e != NULL ? hash_entry (e, struct dentry, elem) : NULL;
+}
+
+/* Removes D from the cache and frees it.  Must be called with
+   dcache_lock held. */
+static void
+remove_dentry (struct dentry *d)
+{
+  hash_delete (&dcache_map, &d->elem);
+  list_remove (&d->lru_elem);
+  free (d);
+}
+
+static unsigned
+dentry_hash (const struct hash_elem *e, void *aux UNUSED)
+{
+  const struct dentry *d = hash_entry (e, struct dentry, elem);
+
+  return hash_string (d->name) ^ hash_int (d->parent);
+}
+
+static bool
+dentry_less (const struct hash_elem *a_, const struct hash_elem *b_,
+             void *aux UNUSED)
+{
+  const struct dentry *a = hash_entry (a_, struct dentry, elem);
+  const struct dentry *b = hash_entry (b_, struct dentry, elem);
+
+  if (a->parent != b->parent)
+    return a->parent < b->parent;
+  return strcmp (a->name, b->name) < 0;
+}
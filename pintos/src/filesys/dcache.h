@@ -0,0 +1,22 @@
+#ifndef FILESYS_DCACHE_H
+#define FILESYS_DCACHE_H
+
+#include <stdbool.h>
+#include "devices/block.h"
+
+/* Maximum number of names kept in the directory entry cache. */
+#define DCACHE_SIZE 256
+
+/* Child sector recorded for a name known not to exist.  Sector 0
+   holds the free map inode, so it is never a directory entry. */
+#define DCACHE_NEGATIVE 0
+
+void dcache_init (void);
+bool dcache_lookup (block_sector_t parent, const char *name,
+                    block_sector_t *child);
+void dcache_insert (block_sector_t parent, const char *name,
+                    block_sector_t child);
+void dcache_invalidate (block_sector_t parent, const char *name);
+void dcache_purge_dir (block_sector_t parent);
+
+#endif /* filesys/dcache.h */
@@ -2,6 +2,9 @@
 #include <stdio.h>
 #include <string.h>
 #include <list.h>
+#include <hash.h>		// IMTC
+#include <dirent.h>		// IMTC
+#include "filesys/dcache.h"	// IMTC
 #include "filesys/filesys.h"
 #include "filesys/inode.h"
 #include "threads/malloc.h"
@@ -11,6 +14,7 @@ struct dir
   {
     struct inode *inode;                /* Backing store. */
     off_t pos;                          /* Current position. */
+    bool listing;                       /* Counted as listing INODE? */	// IMTC
   };
 
 /* A single directory entry. */
@@ -18,15 +22,103 @@ struct dir_entry
   {
     block_sector_t inode_sector;        /* Sector number of header. */
     char name[NAME_MAX + 1];            /* Null terminated file name. */
-    bool in_use;                        /* In use or free? */
+    uint8_t type;                       /* DIRENT_FILE, DIRENT_DIR, or 0 if free. */	// IMTC
   };
 
+/* A directory is an extendible hash table.  Sector 0 of the
+   directory file is a header whose table maps the low DEPTH bits
+   of a name's hash to the file sector of a bucket.  Each bucket
+   fills one sector.  A full bucket is split in two on the next
+   bit of the hash, doubling the table first if necessary.  Once
+   the table is at its largest, or while the directory is being
+   listed, full buckets get overflow buckets chained after them
+   instead.  A chain below the largest depth is split as a whole
+   when it next fills up outside a listing. */
+#define DIR_MAGIC 0x44495248				// IMTC
+#define DIR_MAX_DEPTH 7					// IMTC
+#define DIR_TABLE_SIZE (1 << DIR_MAX_DEPTH)		// IMTC
+#define BUCKET_ENTRIES 25				// IMTC
+
+// IMTS
+struct dir_header
+  {
+    unsigned magic;                     /* DIR_MAGIC. */
+    uint32_t depth;                     /* Table has 1 << DEPTH slots. */
+    uint32_t entry_cnt;                 /* Entries in use. */
+    uint32_t sector_cnt;                /* File sectors in use. */
+    uint16_t table[DIR_TABLE_SIZE];     /* Hash to bucket sector. */
+  };
+
+// IMTS
+struct dir_bucket
+  {
+    uint16_t depth;                     /* Hash bits shared by entries. */
+    uint16_t next;                      /* Overflow bucket sector, or 0. */
+    struct dir_entry entries[BUCKET_ENTRIES];
+  };
+
+static void read_header (const struct dir *, struct dir_header *);	// IMTC
+static void write_header (struct dir *, const struct dir_header *);	// IMTC
+static void read_bucket (const struct dir *, uint16_t, struct dir_bucket *);	// IMTC
+static void write_bucket (struct dir *, uint16_t, const struct dir_bucket *);	// IMTC
+static bool insert (struct dir *, const struct dir_entry *);		// IMTC
+static void adjust_entry_cnt (struct dir *, int delta);			// IMTC
+
+/* Returns the byte offset of entry SLOT of bucket sector IDX. */
+static inline off_t
+entry_ofs (uint16_t idx, int slot)
+{
+  return (idx * BLOCK_SECTOR_SIZE + offsetof (struct dir_bucket, entries)
+          + slot * sizeof (struct dir_entry));
+}
+
+/* Returns the table slot for HASH in a table of depth DEPTH. */
+static inline unsigned
+table_slot (unsigned hash, unsigned depth)
+{
+  return hash & ((1u << depth) - 1);
+}
+
 /* Creates a directory with space for ENTRY_CNT entries in the
    given SECTOR.  Returns true if successful, false on failure. */
 bool
 dir_create (block_sector_t sector, size_t entry_cnt)
 {
-  return inode_create (sector, entry_cnt * sizeof (struct dir_entry));
+  struct dir *dir;					// IMTC
+  struct dir_header *h;					// IMTC
+  struct dir_bucket *b;					// IMTC
+  unsigned i;						// IMTC
+  bool success = false;					// IMTC
+
+  if (!inode_create (sector, 0, true))			// IMTC
+    return false;					// IMTC
+  dcache_purge_dir (sector);				// IMTC
+  dir = dir_open (inode_open (sector));			// IMTC
+  h = calloc (1, sizeof *h);				// IMTC
+  b = calloc (1, sizeof *b);				// IMTC
+  if (dir == NULL || h == NULL || b == NULL)		// IMTC
+    goto done;						// IMTC
+
+  /* Start with enough buckets for ENTRY_CNT entries. */
+  h->magic = DIR_MAGIC;					// IMTC
+  while (h->depth < DIR_MAX_DEPTH			// IMTC
+         && ((size_t) BUCKET_ENTRIES << h->depth) < entry_cnt)	// IMTC
+    h->depth++;						// IMTC
+  h->sector_cnt = 1 + (1u << h->depth);			// IMTC
+  b->depth = h->depth;					// IMTC
+  for (i = 0; i < (1u << h->depth); i++)		// IMTC
+    {
+      h->table[i] = 1 + i;				// IMTC
+      write_bucket (dir, 1 + i, b);			// IMTC
+    }
+  write_header (dir, h);				// IMTC
+  success = inode_length (dir->inode) == (off_t) (h->sector_cnt * BLOCK_SECTOR_SIZE);	// IMTC
+
+ done:
+  free (b);						// IMTC
+  free (h);						// IMTC
+  dir_close (dir);					// IMTC
+  return success;					// IMTC
 }
 
 /* Opens and returns the directory for the given INODE, of which
@@ -39,6 +131,7 @@ dir_open (struct inode *inode)
     {
       dir->inode = inode;
       dir->pos = 0;
+      dir->listing = false;		// IMTC
       return dir;
     }
   else
@@ -71,6 +164,8 @@ dir_close (struct dir *dir)
 {
   if (dir != NULL)
     {
+      if (dir->listing)				// IMTC
+        inode_end_listing (dir->inode);		// IMTC
       inode_close (dir->inode);
       free (dir);
     }
@@ -92,23 +187,61 @@ static bool
 lookup (const struct dir *dir, const char *name,
         struct dir_entry *ep, off_t *ofsp) 
 {
-  struct dir_entry e;
-  size_t ofs;
+  struct dir_bucket *b;					// IMTC
+  uint32_t depth;					// IMTC
+  uint16_t idx;						// IMTC
+  bool found = false;					// IMTC
+  int i;						// IMTC
   
   ASSERT (dir != NULL);
   ASSERT (name != NULL);
 
-  for (ofs = 0; inode_read_at (dir->inode, &e, sizeof e, ofs) == sizeof e;
-       ofs += sizeof e) 
-    if (e.in_use && !strcmp (name, e.name)) 
-      {
-        if (ep != NULL)
-          *ep = e;
-        if (ofsp != NULL)
-          *ofsp = ofs;
-        return true;
-      }
-  return false;
+  b = malloc (sizeof *b);				// IMTC
+  if (b == NULL)					// IMTC
+    return false;					// IMTC
+
+  /* Only NAME's bucket and its overflow chain can hold it. */
+  inode_read_at (dir->inode, &depth, sizeof depth,	// IMTC
+                 offsetof (struct dir_header, depth));	// IMTC
+  inode_read_at (dir->inode, &idx, sizeof idx,		// IMTC
+                 offsetof (struct dir_header, table)	// IMTC
+                 + table_slot (hash_string (name), depth) * sizeof idx);	// IMTC
+  for (; idx != 0 && !found; idx = b->next)		// IMTC
+    {
+      read_bucket (dir, idx, b);			// IMTC
+      for (i = 0; i < BUCKET_ENTRIES; i++)		// IMTC
+        if (b->entries[i].type != 0 && !strcmp (name, b->entries[i].name))	// IMTC
+          {
+            if (ep != NULL)
+              *ep = b->entries[i];			// IMTC
+            if (ofsp != NULL)
+              *ofsp = entry_ofs (idx, i);		// IMTC
+            found = true;				// IMTC
+            break;					// IMTC
+          }
+    }
+  free (b);						// IMTC
+  return found;						// IMTC
+}
+
+// IMTF
+/* Searches DIR for NAME, first in the directory entry cache and
+   then on disk, remembering the answer either way.  Returns true
+   and sets *SECTORP to the file's inode sector if NAME exists,
+   otherwise returns false. */
+static bool
+cached_lookup (const struct dir *dir, const char *name,
+               block_sector_t *sectorp)
+{
+  block_sector_t parent = inode_get_inumber (dir->inode);
+  struct dir_entry e;
+
+  if (!dcache_lookup (parent, name, sectorp))
+  {
+    *sectorp = lookup (dir, name, &e, NULL) ? e.inode_sector : DCACHE_NEGATIVE;
+    dcache_insert (parent, name, *sectorp);
+  }
+  return *sectorp != DCACHE_NEGATIVE;
 }
 
 /* Searches DIR for a file with the given NAME
@@ -119,30 +252,34 @@ bool
 dir_lookup (const struct dir *dir, const char *name,
             struct inode **inode) 
 {
-  struct dir_entry e;
+  block_sector_t sector;		// IMTC
 
   ASSERT (dir != NULL);
   ASSERT (name != NULL);
 
-  if (lookup (dir, name, &e, NULL))
-    *inode = inode_open (e.inode_sector);
+  inode_lock_dir (dir->inode);			// IMTC
+  inode_count (dir->inode, FSSTAT_DIR_LOOKUPS, 1);	// IMTC
+  if (cached_lookup (dir, name, &sector))	// IMTC
+    *inode = inode_open (sector);		// IMTC
   else
     *inode = NULL;
+  inode_unlock_dir (dir->inode);		// IMTC
 
   return *inode != NULL;
 }
 
 /* Adds a file named NAME to DIR, which must not already contain a
    file by that name.  The file's inode is in sector
-   INODE_SECTOR.
+   INODE_SECTOR, and IS_DIR tells whether it is a directory.
    Returns true if successful, false on failure.
    Fails if NAME is invalid (i.e. too long) or a disk or memory
    error occurs. */
 bool
-dir_add (struct dir *dir, const char *name, block_sector_t inode_sector)
+dir_add (struct dir *dir, const char *name, block_sector_t inode_sector,
+         bool is_dir)						// IMTC
 {
   struct dir_entry e;
-  off_t ofs;
+  block_sector_t sector;		// IMTC
   bool success = false;
 
   ASSERT (dir != NULL);
@@ -153,28 +290,20 @@ dir_add (struct dir *dir, const char *name, block_sector_t inode_sector)
     return false;
 
   /* Check that NAME is not in use. */
-  if (lookup (dir, name, NULL, NULL))
+  inode_lock_dir (dir->inode);			// IMTC
+  if (cached_lookup (dir, name, &sector))	// IMTC
     goto done;
 
-  /* Set OFS to offset of free slot.
-     If there are no free slots, then it will be set to the
-     current end-of-file.
-     
-     inode_read_at() will only return a short read at end of file.
-     Otherwise, we'd need to verify that we didn't get a short
-     read due to something intermittent such as low memory. */
-  for (ofs = 0; inode_read_at (dir->inode, &e, sizeof e, ofs) == sizeof e;
-       ofs += sizeof e) 
-    if (!e.in_use)
-      break;
-
-  /* Write slot. */
-  e.in_use = true;
+  /* Write slot in NAME's bucket. */
+  memset (&e, 0, sizeof e);				// IMTC
+  e.type = is_dir ? DIRENT_DIR : DIRENT_FILE;		// IMTC
   strlcpy (e.name, name, sizeof e.name);
   e.inode_sector = inode_sector;
-  success = inode_write_at (dir->inode, &e, sizeof e, ofs) == sizeof e;
+  success = insert (dir, &e);				// IMTC
+  dcache_invalidate (inode_get_inumber (dir->inode), name);	// IMTC
 
  done:
+  inode_unlock_dir (dir->inode);		// IMTC
   return success;
 }
 
@@ -193,6 +322,7 @@ dir_remove (struct dir *dir, const char *name)
   ASSERT (name != NULL);
 
   /* Find directory entry. */
+  inode_lock_dir (dir->inode);		// IMTC
   if (!lookup (dir, name, &e, &ofs))
     goto done;
 
@@ -202,35 +332,343 @@ dir_remove (struct dir *dir, const char *name)
     goto done;
 
   /* Erase directory entry. */
-  e.in_use = false;
+  dcache_invalidate (inode_get_inumber (dir->inode), name);	// IMTC
+  e.type = 0;					// IMTC
   if (inode_write_at (dir->inode, &e, sizeof e, ofs) != sizeof e) 
     goto done;
+  adjust_entry_cnt (dir, -1);		// IMTC
 
   /* Remove inode. */
   inode_remove (inode);
   success = true;
 
  done:
+  inode_unlock_dir (dir->inode);	// IMTC
   inode_close (inode);
   return success;
 }
 
 /* Reads the next directory entry in DIR and stores the name in
    NAME.  Returns true if successful, false if the directory
-   contains no more entries. */
+   contains no more entries.
+   Entries are returned in bucket order; DIR's position counts
+   entry slots across the buckets.  Buckets are not split while
+   DIR is open, so every entry that is neither added nor removed
+   meanwhile is returned exactly once. */
 bool
 dir_readdir (struct dir *dir, char name[NAME_MAX + 1])
 {
   struct dir_entry e;
+  off_t ofs;						// IMTC
+  bool found = false;					// IMTC
 
-  while (inode_read_at (dir->inode, &e, sizeof e, dir->pos) == sizeof e) 
+  if (!dir->listing)					// IMTC
     {
-      dir->pos += sizeof e;
-      if (e.in_use)
+      inode_begin_listing (dir->inode);			// IMTC
+      dir->listing = true;				// IMTC
+    }
+  inode_lock_dir (dir->inode);				// IMTC
+  for (;;)						// IMTC
+    {
+      ofs = entry_ofs (1 + dir->pos / BUCKET_ENTRIES, dir->pos % BUCKET_ENTRIES);	// IMTC
+      if (inode_read_at (dir->inode, &e, sizeof e, ofs) != sizeof e)	// IMTC
+        break;						// IMTC
+      dir->pos++;					// IMTC
+      if (e.type != 0)					// IMTC
         {
           strlcpy (name, e.name, NAME_MAX + 1);
-          return true;
+          found = true;					// IMTC
+          break;					// IMTC
         } 
     }
-  return false;
+  inode_unlock_dir (dir->inode);			// IMTC
+  return found;						// IMTC
+}
+
+// IMTF
+/* Reads up to CNT entries of DIR into ENTS, starting at entry
+   slot *COOKIE, and advances *COOKIE past the last slot examined
+   so that the next call resumes there.  Each bucket is read with
+   a single inode_read_at() call.  Returns the number of entries
+   stored, which is 0 at the end of the directory, or -1 if
+   memory runs out.
+   A cookie only stays meaningful while entries keep their slots,
+   so the caller must have called inode_begin_listing() on DIR's
+   inode for as long as it goes on listing; entries added in the
+   meantime may or may not be returned. */
+int
+dir_read_entries (struct dir *dir, off_t *cookie, struct dirent *ents, int cnt)
+{
+  struct dir_bucket *b = malloc (sizeof *b);
+  int n = 0;
+  int i;
+
+  if (b == NULL)
+    return -1;
+
+  inode_lock_dir (dir->inode);
+  while (n < cnt && *cookie >= 0)
+  {
+    uint16_t idx = 1 + *cookie / BUCKET_ENTRIES;
+
+    if (inode_read_at (dir->inode, b, sizeof *b,
+                       idx * BLOCK_SECTOR_SIZE) != sizeof *b)
+      break;
+    for (i = *cookie % BUCKET_ENTRIES; i < BUCKET_ENTRIES && n < cnt;
+         i++, ++*cookie)
+      if (b->entries[i].type != 0)
+      {
+	ents[n].inumber = b->entries[i].inode_sector;
+	ents[n].type = b->entries[i].type;
+	strlcpy (ents[n].name, b->entries[i].name, sizeof ents[n].name);
+	n++;
+      }
+  }
+  inode_unlock_dir (dir->inode);
+
+  free (b);
+  return n;
+}
+
+// IMTF
+/* Reads DIR's header into *H. */
+static void
+read_header (const struct dir *dir, struct dir_header *h)
+{
+  inode_read_at (dir->inode, h, sizeof *h, 0);
+  ASSERT (h->magic == DIR_MAGIC);
+}
+
+// IMTF
+/* Writes *H as DIR's header. */
+static void
+write_header (struct dir *dir, const struct dir_header *h)
+{
+  inode_write_at (dir->inode, h, sizeof *h, 0);
+}
+
+// IMTF
+/* Reads the bucket in file sector IDX of DIR into *B. */
+static void
+read_bucket (const struct dir *dir, uint16_t idx, struct dir_bucket *b)
+{
+  inode_read_at (dir->inode, b, sizeof *b, idx * BLOCK_SECTOR_SIZE);
+}
+
+// IMTF
+/* Writes *B to file sector IDX of DIR. */
+static void
+write_bucket (struct dir *dir, uint16_t idx, const struct dir_bucket *b)
+{
+  inode_write_at (dir->inode, b, sizeof *b, idx * BLOCK_SECTOR_SIZE);
+}
+
+// IMTF
+/* Adds DELTA to the number of entries recorded in DIR's header. */
+static void
+adjust_entry_cnt (struct dir *dir, int delta)
+{
+  uint32_t cnt;
+  off_t ofs = offsetof (struct dir_header, entry_cnt);
+
+  inode_read_at (dir->inode, &cnt, sizeof cnt, ofs);
+  cnt += delta;
+  inode_write_at (dir->inode, &cnt, sizeof cnt, ofs);
+}
+
+// IMTF
+/* Writes NB as a new bucket at the end of DIR and returns its
+   file sector, or 0 if the directory cannot grow. */
+static uint16_t
+append_bucket (struct dir *dir, struct dir_header *h,
+               const struct dir_bucket *nb)
+{
+  uint16_t idx = h->sector_cnt;
+
+  if (idx == UINT16_MAX)
+    return 0;
+  write_bucket (dir, idx, nb);
+  if (inode_length (dir->inode) < idx * BLOCK_SECTOR_SIZE + (off_t) sizeof *nb)
+    return 0;
+  h->sector_cnt++;
+  return idx;
+}
+
+// IMTF
+/* Splits the full bucket in file sector IDX, together with any
+   overflow buckets chained after it, on the next bit of the
+   hash.  The chain's entries are dealt out again between IDX and
+   a new bucket at the end of the file, and half of the table
+   slots that referred to IDX are repointed to the new bucket.
+   A half that does not fit in one bucket takes overflow buckets
+   from the old chain; any of those left over are emptied.
+   Doubles the table first if the bucket already uses every bit
+   the table does.  B and NB are scratch space.  Returns false if
+   memory runs out or the directory cannot grow. */
+static bool
+split_bucket (struct dir *dir, struct dir_header *h, uint16_t idx,
+              struct dir_bucket *b, struct dir_bucket *nb)
+{
+  uint16_t *sectors = NULL;
+  struct dir_entry *ents = NULL;
+  size_t bucket_cnt = 0, ent_cnt = 0, spare = 1;
+  unsigned bit, depth, half, i;
+  uint16_t s;
+  bool success = false;
+
+  for (s = idx; s != 0; s = b->next)
+  {
+    read_bucket (dir, s, b);
+    bucket_cnt++;
+  }
+
+  /* SECTORS lists the chain, then the new bucket. */
+  sectors = malloc ((bucket_cnt + 1) * sizeof *sectors);
+  ents = malloc (bucket_cnt * BUCKET_ENTRIES * sizeof *ents);
+  if (sectors == NULL || ents == NULL)
+    goto done;
+
+  /* Make room first, so that failure changes nothing. */
+  memset (nb, 0, sizeof *nb);
+  sectors[bucket_cnt] = append_bucket (dir, h, nb);
+  if (sectors[bucket_cnt] == 0)
+    goto done;
+
+  bucket_cnt = 0;
+  for (s = idx; s != 0; s = b->next)
+  {
+    read_bucket (dir, s, b);
+    sectors[bucket_cnt++] = s;
+    for (i = 0; i < BUCKET_ENTRIES; i++)
+      if (b->entries[i].type != 0)
+	ents[ent_cnt++] = b->entries[i];
+  }
+  bit = 1u << b->depth;
+  depth = b->depth + 1;
+
+  if (b->depth == h->depth)
+  {
+    for (i = 0; i < (1u << h->depth); i++)
+      h->table[i + (1u << h->depth)] = h->table[i];
+    h->depth++;
+  }
+  for (i = 0; i < (1u << h->depth); i++)
+    if (h->table[i] == idx && (i & bit))
+      h->table[i] = sectors[bucket_cnt];
+
+  /* The chain was full, so the two halves need at most one
+     bucket more than it had, which the new bucket provides. */
+  for (half = 0; half < 2; half++)
+  {
+    uint16_t cur = half == 0 ? idx : sectors[bucket_cnt];
+    int n = 0;
+
+    memset (b, 0, sizeof *b);
+    b->depth = depth;
+    for (i = 0; i < ent_cnt; i++)
+      if (((hash_string (ents[i].name) & bit) != 0) == half)
+      {
+	if (n == BUCKET_ENTRIES)
+	{
+	  ASSERT (spare < bucket_cnt);
+	  b->next = sectors[spare++];
+	  write_bucket (dir, cur, b);
+	  cur = b->next;
+	  memset (b, 0, sizeof *b);
+	  b->depth = depth;
+	  n = 0;
+	}
+	b->entries[n++] = ents[i];
+      }
+    write_bucket (dir, cur, b);
+  }
+
+  memset (b, 0, sizeof *b);
+  b->depth = depth;
+  while (spare < bucket_cnt)
+    write_bucket (dir, sectors[spare++], b);
+  success = true;
+
+ done:
+  free (ents);
+  free (sectors);
+  return success;
+}
+
+// IMTF
+/* Stores E in a free slot of its bucket in DIR, splitting the
+   bucket or chaining an overflow bucket if it is full.
+   Returns false if the directory cannot grow. */
+static bool
+insert (struct dir *dir, const struct dir_entry *e)
+{
+  unsigned hash = hash_string (e->name);
+  struct dir_header *h = malloc (sizeof *h);
+  struct dir_bucket *b = malloc (sizeof *b);
+  struct dir_bucket *nb = malloc (sizeof *nb);
+  bool success = false;
+
+  if (h == NULL || b == NULL || nb == NULL)
+    goto done;
+
+  read_header (dir, h);
+  for (;;)
+  {
+    uint16_t first = h->table[table_slot (hash, h->depth)];
+    uint16_t idx = first;
+    int i;
+
+    /* Look for a free slot along the bucket's chain. */
+    for (;;)
+    {
+      read_bucket (dir, idx, b);
+      for (i = 0; i < BUCKET_ENTRIES; i++)
+	if (b->entries[i].type == 0)
+	{
+	  success = (inode_write_at (dir->inode, e, sizeof *e,
+	                             entry_ofs (idx, i)) == sizeof *e);
+	  goto added;
+	}
+      if (b->next == 0)
+	break;
+      idx = b->next;
+    }
+
+    if (b->depth < DIR_MAX_DEPTH && !inode_is_listed (dir->inode))
+    {
+      /* Split and try again.  A split moves entries to other
+         slots, where a listing in progress could see them a
+         second time, so while the directory is listed the
+         bucket is chained instead; the first insert into the
+         chain after the listing splits it whole. */
+      if (!split_bucket (dir, h, first, b, nb))
+	goto added;
+      write_header (dir, h);
+      continue;
+    }
+
+    /* The table cannot grow any more, or the directory is being
+       listed, so chain a new bucket. */
+    memset (nb, 0, sizeof *nb);
+    nb->depth = b->depth;
+    nb->entries[0] = *e;
+    b->next = append_bucket (dir, h, nb);
+    if (b->next != 0)
+    {
+      write_bucket (dir, idx, b);
+      success = true;
+    }
+    goto added;
+  }
+
+ added:
+  if (success)
+    h->entry_cnt++;
+  write_header (dir, h);
+
+ done:
+  free (nb);
+  free (b);
+  free (h);
+  return success;
 }
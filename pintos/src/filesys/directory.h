@@ -4,6 +4,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include "devices/block.h"
+#include "filesys/off_t.h"	// IMTC
 
 /* Maximum length of a file name component.
    This is the traditional UNIX maximum length.
@@ -12,6 +13,7 @@
 #define NAME_MAX 14
 
 struct inode;
+struct dirent;		// IMTC
 
 /* Opening and closing directories. */
 bool dir_create (block_sector_t sector, size_t entry_cnt);
@@ -23,8 +25,9 @@ struct inode *dir_get_inode (struct dir *);
 
 /* Reading and writing. */
 bool dir_lookup (const struct dir *, const char *name, struct inode **);
-bool dir_add (struct dir *, const char *name, block_sector_t);
+bool dir_add (struct dir *, const char *name, block_sector_t, bool is_dir);	// IMTC
 bool dir_remove (struct dir *, const char *name);
 bool dir_readdir (struct dir *, char name[NAME_MAX + 1]);
+int dir_read_entries (struct dir *, off_t *cookie, struct dirent *, int cnt);	// IMTC
 
 #endif /* filesys/directory.h */
@@ -1,16 +1,33 @@
 #include "filesys/file.h"
 #include <debug.h>
 #include "filesys/inode.h"
+#include "devices/block.h"		// IMTC
 #include "threads/malloc.h"
 
+/* Read-ahead window bounds, in sectors.  The window starts at
+   READ_AHEAD_MIN on the first sequential read and doubles on
+   each further one. */
+#define READ_AHEAD_MIN 4		// IMTC
+#define READ_AHEAD_MAX 32		// IMTC
+
+/* Bytes moved per step by file_copy_range(). */
+#define COPY_CHUNK (8 * BLOCK_SECTOR_SIZE)	// IMTC
+
 /* An open file. */
 struct file 
   {
     struct inode *inode;        /* File's inode. */
     off_t pos;                  /* Current position. */
     bool deny_write;            /* Has file_deny_write() been called? */
+    off_t ra_next;              /* Where a sequential read would start. */
+    off_t ra_end;               /* End of data queued for read-ahead. */
+    int ra_window;              /* Read-ahead window in sectors, 0 if off. */
+    bool direct;                /* Bypass the buffer cache when possible? */	// IMTC
+    bool listing;               /* Counted as listing the directory? */	// IMTC
   };
 
+static void read_ahead (struct file *, off_t offset, off_t bytes_read);	// IMTC
+
 /* Opens a file for the given INODE, of which it takes ownership,
    and returns the new file.  Returns a null pointer if an
    allocation fails or if INODE is null. */
@@ -23,6 +40,10 @@ file_open (struct inode *inode)
       file->inode = inode;
       file->pos = 0;
       file->deny_write = false;
+      file->ra_next = file->ra_end = 0;	// IMTC
+      file->ra_window = 0;		// IMTC
+      file->direct = false;		// IMTC
+      file->listing = false;		// IMTC
       return file;
     }
   else
@@ -48,6 +69,8 @@ file_close (struct file *file)
   if (file != NULL)
     {
       file_allow_write (file);
+      if (file->listing)			// IMTC
+        inode_end_listing (file->inode);	// IMTC
       inode_close (file->inode);
       free (file); 
     }
@@ -69,6 +92,7 @@ off_t
 file_read (struct file *file, void *buffer, off_t size) 
 {
   off_t bytes_read = inode_read_at (file->inode, buffer, size, file->pos);
+  read_ahead (file, file->pos, bytes_read);	// IMTC
   file->pos += bytes_read;
   return bytes_read;
 }
@@ -81,20 +105,64 @@ file_read (struct file *file, void *buffer, off_t size)
 off_t
 file_read_at (struct file *file, void *buffer, off_t size, off_t file_ofs) 
 {
-  return inode_read_at (file->inode, buffer, size, file_ofs);
+  off_t bytes_read = inode_read_at (file->inode, buffer, size, file_ofs);	// IMTC
+  read_ahead (file, file_ofs, bytes_read);	// IMTC
+  return bytes_read;				// IMTC
+}
+
+// IMTF
+/* Updates FILE's read-ahead state after BYTES_READ bytes were
+   read at OFFSET.  A read that starts where the previous one
+   ended grows the window and queues the sectors that follow it;
+   any other read collapses the window. */
+static void
+read_ahead (struct file *file, off_t offset, off_t bytes_read)
+{
+  off_t end = offset + bytes_read;
+  off_t start, limit;
+
+  if (offset != file->ra_next || bytes_read == 0)
+  {
+    file->ra_next = end;
+    file->ra_end = 0;
+    file->ra_window = 0;
+    return;
+  }
+
+  file->ra_next = end;
+  if (file->ra_window == 0)
+    file->ra_window = READ_AHEAD_MIN;
+  else if (file->ra_window < READ_AHEAD_MAX)
+    file->ra_window *= 2;
+
+  /* Only queue what earlier calls have not already queued.
+     Sectors the cache had no room for are left for the next
+     read to queue, and the window is held back meanwhile. */
+  start = end > file->ra_end ? end : file->ra_end;
+  limit = end + file->ra_window * BLOCK_SECTOR_SIZE;
+  if (start < limit)
+  {
+    file->ra_end = inode_read_ahead (file->inode, start, limit - start);
+    if (file->ra_end < limit && file->ra_window > READ_AHEAD_MIN)
+      file->ra_window /= 2;
+  }
 }
 
 /* Writes SIZE bytes from BUFFER into FILE,
    starting at the file's current position.
    Returns the number of bytes actually written,
-   which may be less than SIZE if end of file is reached.
-   (Normally we'd grow the file in that case, but file growth is
-   not yet implemented.)
+   which may be less than SIZE if the disk fills up.
+   Writing past end of file grows the file.
+   Directories cannot be written this way.
    Advances FILE's position by the number of bytes read. */
 off_t
 file_write (struct file *file, const void *buffer, off_t size) 
 {
-  off_t bytes_written = inode_write_at (file->inode, buffer, size, file->pos);
+  off_t bytes_written;						// IMTC
+
+  if (inode_is_dir (file->inode))				// IMTC
+    return 0;							// IMTC
+  bytes_written = inode_write_at (file->inode, buffer, size, file->pos);	// IMTC
   file->pos += bytes_written;
   return bytes_written;
 }
@@ -102,17 +170,145 @@ file_write (struct file *file, const void *buffer, off_t size)
 /* Writes SIZE bytes from BUFFER into FILE,
    starting at offset FILE_OFS in the file.
    Returns the number of bytes actually written,
-   which may be less than SIZE if end of file is reached.
-   (Normally we'd grow the file in that case, but file growth is
-   not yet implemented.)
+   which may be less than SIZE if the disk fills up.
+   Writing past end of file grows the file.
+   Directories cannot be written this way.
    The file's current position is unaffected. */
 off_t
 file_write_at (struct file *file, const void *buffer, off_t size,
                off_t file_ofs) 
 {
+  if (inode_is_dir (file->inode))				// IMTC
+    return 0;							// IMTC
   return inode_write_at (file->inode, buffer, size, file_ofs);
 }
 
+// IMTF
+/* Copies up to SIZE bytes from IN, starting at IN_OFS, to OUT,
+   starting at OUT_OFS, without passing through user memory.
+   Data moves from the buffer cache to the buffer cache a few
+   sectors at a time.  Returns the number of bytes copied, which
+   is less than SIZE if end of file is reached in IN, OUT cannot
+   be written or memory runs out.  Neither file's position is
+   changed. */
+off_t
+file_copy_range (struct file *in, off_t in_ofs, struct file *out,
+                 off_t out_ofs, off_t size)
+{
+  uint8_t *buffer;
+  off_t copied = 0;
+
+  buffer = malloc (COPY_CHUNK);
+  if (buffer == NULL)
+    return 0;
+
+  while (size > 0)
+  {
+    off_t chunk = size < COPY_CHUNK ? size : COPY_CHUNK;
+    off_t bytes_read, bytes_written;
+
+    bytes_read = file_read_at (in, buffer, chunk, in_ofs);
+    if (bytes_read == 0)
+      break;
+    bytes_written = file_write_at (out, buffer, bytes_read, out_ofs);
+    copied += bytes_written;
+    if (bytes_written < bytes_read)
+      break;
+
+    in_ofs += bytes_read;
+    out_ofs += bytes_read;
+    size -= bytes_read;
+  }
+
+  free (buffer);
+  return copied;
+}
+
+// IMTF
+/* Marks FILE, which must be open on a directory, as listing the
+   directory's entries.  The directory's buckets are not split
+   from then until FILE is closed, so that entry positions handed
+   out as cookies stay valid. */
+void
+file_begin_listing (struct file *file)
+{
+  ASSERT (inode_is_dir (file->inode));
+  if (!file->listing)
+    {
+      inode_begin_listing (file->inode);
+      file->listing = true;
+    }
+}
+
+// IMTF
+/* Sets whether FILE does direct I/O.  Sector-aligned transfers
+   on a direct file move straight between the disk and the
+   caller's buffer, skipping the buffer cache. */
+void
+file_set_direct (struct file *file, bool direct)
+{
+  file->direct = direct;
+}
+
+// IMTF
+/* Returns true if a transfer of SIZE bytes at offset FILE_OFS,
+   to or from BUFFER, can be done directly on FILE: FILE must be
+   direct and all three must be multiples of BLOCK_SECTOR_SIZE. */
+bool
+file_can_direct (struct file *file, const void *buffer, off_t size,
+                 off_t file_ofs)
+{
+  return (file->direct && !inode_is_dir (file->inode)
+          && (uintptr_t) buffer % BLOCK_SECTOR_SIZE == 0
+          && size % BLOCK_SECTOR_SIZE == 0
+          && file_ofs % BLOCK_SECTOR_SIZE == 0);
+}
+
+// IMTF
+/* Reads SIZE bytes from FILE into BUFFER, starting at FILE_OFS,
+   bypassing the buffer cache.  file_can_direct() must allow the
+   transfer.  Returns the number of bytes read, which is less than
+   SIZE at end of file.  The file's position is unaffected. */
+off_t
+file_read_direct (struct file *file, void *buffer, off_t size, off_t file_ofs)
+{
+  ASSERT (file_can_direct (file, buffer, size, file_ofs));
+  return inode_read_direct (file->inode, buffer, size, file_ofs);
+}
+
+// IMTF
+/* Writes SIZE bytes from BUFFER into FILE, starting at FILE_OFS,
+   bypassing the buffer cache.  file_can_direct() must allow the
+   transfer.  Returns the number of bytes written, which is less
+   than SIZE if the disk fills up.  The file's position is
+   unaffected. */
+off_t
+file_write_direct (struct file *file, const void *buffer, off_t size,
+                   off_t file_ofs)
+{
+  ASSERT (file_can_direct (file, buffer, size, file_ofs));
+  return inode_write_direct (file->inode, buffer, size, file_ofs);
+}
+
+// IMTF
+/* Writes FILE's dirty data and its inode back to disk, without
+   waiting for the buffer cache's flusher thread. */
+void
+file_sync (struct file *file)
+{
+  inode_flush (file->inode);
+}
+
+// IMTF
+/* Allocates disk space for FILE to grow to LENGTH bytes, so that
+   a file about to be written in full ends up in long runs on
+   disk.  Returns false if the disk fills up first. */
+bool
+file_reserve (struct file *file, off_t length)
+{
+  return inode_reserve (file->inode, length);
+}
+
 /* Prevents write operations on FILE's underlying inode
    until file_allow_write() is called or FILE is closed. */
 void
@@ -17,6 +17,17 @@ off_t file_read (struct file *, void *, off_t);
 off_t file_read_at (struct file *, void *, off_t size, off_t start);
 off_t file_write (struct file *, const void *, off_t);
 off_t file_write_at (struct file *, const void *, off_t size, off_t start);
+off_t file_copy_range (struct file *in, off_t in_start,
+                       struct file *out, off_t out_start, off_t size);	// IMTC
+void file_sync (struct file *);		// IMTC
+void file_begin_listing (struct file *);	// IMTC
+
+/* Direct I/O. */
+void file_set_direct (struct file *, bool);	// IMTC
+bool file_can_direct (struct file *, const void *, off_t size, off_t start);	// IMTC
+off_t file_read_direct (struct file *, void *, off_t size, off_t start);	// IMTC
+off_t file_write_direct (struct file *, const void *, off_t size, off_t start);	// IMTC
+bool file_reserve (struct file *, off_t length);	// IMTC
 
 /* Preventing writes. */
 void file_deny_write (struct file *);
@@ -2,6 +2,8 @@
 #include <debug.h>
 #include <stdio.h>
 #include <string.h>
+#include "filesys/cache.h"		// IMTC
+#include "filesys/dcache.h"		// IMTC
 #include "filesys/file.h"
 #include "filesys/free-map.h"
 #include "filesys/inode.h"
@@ -22,6 +24,8 @@ filesys_init (bool format)
     PANIC ("No file system device found, can't initialize file system.");
 
   inode_init ();
+  cache_init ();		// IMTC
+  dcache_init ();		// IMTC
   free_map_init ();
 
   if (format) 
@@ -35,10 +39,13 @@ filesys_init (bool format)
 void
 filesys_done (void) 
 {
+  inode_flush_tails (INT64_MAX);	// IMTC
   free_map_close ();
+  cache_flush ();		// IMTC
 }
 
 /* Creates a file named NAME with the given INITIAL_SIZE.
+   The new inode is placed near its directory's inode.	// IMTC
    Returns true if successful, false otherwise.
    Fails if a file named NAME already exists,
    or if internal memory allocation fails. */
@@ -48,9 +55,10 @@ filesys_create (const char *name, off_t initial_size)
   block_sector_t inode_sector = 0;
   struct dir *dir = dir_open_root ();
   bool success = (dir != NULL
-                  && free_map_allocate (1, &inode_sector)
-                  && inode_create (inode_sector, initial_size)
-                  && dir_add (dir, name, inode_sector));
+                  && free_map_allocate_near (inode_get_inumber (dir_get_inode (dir)),	// IMTC
+                                             1, &inode_sector) == 1	// IMTC
+                  && inode_create (inode_sector, initial_size, false)	// IMTC
+                  && dir_add (dir, name, inode_sector, false));	// IMTC
   if (!success && inode_sector != 0) 
     free_map_release (inode_sector, 1);
   dir_close (dir);
@@ -61,6 +69,7 @@ filesys_create (const char *name, off_t initial_size)
 /* Opens the file with the given NAME.
    Returns the new file if successful or a null pointer
    otherwise.
+   "/" and "." name the root directory itself.
    Fails if no file named NAME exists,
    or if an internal memory allocation fails. */
 struct file *
@@ -69,7 +78,9 @@ filesys_open (const char *name)
   struct dir *dir = dir_open_root ();
   struct inode *inode = NULL;
 
-  if (dir != NULL)
+  if (dir != NULL && (!strcmp (name, "/") || !strcmp (name, ".")))	// IMTC
+    inode = inode_reopen (dir_get_inode (dir));			// IMTC
+  else if (dir != NULL)						// IMTC
     dir_lookup (dir, name, &inode);
   dir_close (dir);
 
@@ -1,12 +1,45 @@
 #include "filesys/free-map.h"
 #include <bitmap.h>
 #include <debug.h>
+#include <limits.h>	// IMTC
+#include <round.h>	// IMTC
 #include "filesys/file.h"
 #include "filesys/filesys.h"
+#include "filesys/fsstat.h"	// IMTC
 #include "filesys/inode.h"
+#include "threads/malloc.h"	// IMTC
+#include "threads/synch.h"	// IMTC
+#include "threads/thread.h"	// IMTC
+#include "devices/timer.h"	// IMTC
+
+/* Free map bits held by one sector of the free map file. */
+#define BITS_PER_SECTOR (BLOCK_SECTOR_SIZE * CHAR_BIT)	// IMTC
+
+/* Sectors per allocation group.  A group covers the bits held
+   by one sector of the free map file. */
+#define GROUP_SECTORS BITS_PER_SECTOR	// IMTC
+
+/* Ticks between background writes of the free map. */
+#define FREE_MAP_FLUSH_INTERVAL TIMER_FREQ	// IMTC
 
 static struct file *free_map_file;   /* Free map file. */
 static struct bitmap *free_map;      /* Free map, one bit per sector. */
+static struct bitmap *dirty_map;     /* Free map file sectors to write. */	// IMTC
+static struct lock free_map_lock;    /* Protects the maps and groups. */	// IMTC
+
+/* Allocation groups.  Each group's free sector count lets
+   searches skip groups that cannot satisfy them, so allocation
+   does not slow down as the disk fills. */
+static size_t group_cnt;             /* Number of groups. */	// IMTC
+static size_t *group_free;           /* Free sectors in each group. */	// IMTC
+
+static void mark_dirty (block_sector_t, size_t cnt);	// IMTC
+static void count_groups (void);			// IMTC
+static void take_sectors (block_sector_t, size_t cnt);	// IMTC
+static void adjust_groups (block_sector_t, size_t cnt, bool freed);	// IMTC
+static size_t find_run (size_t start, size_t end, size_t cnt);	// IMTC
+static void flush_locked (struct file *);		// IMTC
+static void free_map_flushd (void *);			// IMTC
 
 /* Initializes the free map. */
 void
@@ -17,36 +50,112 @@ free_map_init (void)
     PANIC ("bitmap creation failed--file system device is too large");
   bitmap_mark (free_map, FREE_MAP_SECTOR);
   bitmap_mark (free_map, ROOT_DIR_SECTOR);
+
+  dirty_map = bitmap_create (DIV_ROUND_UP (bitmap_file_size (free_map),	// IMTC
+                                           BLOCK_SECTOR_SIZE));		// IMTC
+  if (dirty_map == NULL)						// IMTC
+    PANIC ("bitmap creation failed--file system device is too large");	// IMTC
+  lock_init (&free_map_lock);						// IMTC
+
+  group_cnt = DIV_ROUND_UP (bitmap_size (free_map), GROUP_SECTORS);	// IMTC
+  group_free = malloc (group_cnt * sizeof *group_free);			// IMTC
+  if (group_free == NULL)						// IMTC
+    PANIC ("allocation group creation failed");				// IMTC
+  count_groups ();							// IMTC
 }
 
 /* Allocates CNT consecutive sectors from the free map and stores
    the first into *SECTORP.
    Returns true if successful, false if not enough consecutive
-   sectors were available or if the free_map file could not be
-   written. */
+   sectors were available.
+   The change reaches the free map file on the next flush. */
 bool
 free_map_allocate (size_t cnt, block_sector_t *sectorp)
 {
-  block_sector_t sector = bitmap_scan_and_flip (free_map, 0, cnt, false);
-  if (sector != BITMAP_ERROR
-      && free_map_file != NULL
-      && !bitmap_write (free_map, free_map_file))
+  block_sector_t sector = BITMAP_ERROR;	// IMTC
+  size_t g;				// IMTC
+
+  lock_acquire (&free_map_lock);				// IMTC
+  for (g = 0; g < group_cnt && sector == BITMAP_ERROR; g++)	// IMTC
+    if (group_free[g] >= cnt)					// IMTC
+      sector = find_run (g * GROUP_SECTORS, (g + 1) * GROUP_SECTORS, cnt);	// IMTC
+  if (sector == BITMAP_ERROR)					// IMTC
+    sector = bitmap_scan (free_map, 0, cnt, false);		// IMTC
+  if (sector != BITMAP_ERROR)
     {
-      bitmap_set_multiple (free_map, sector, cnt, false); 
-      sector = BITMAP_ERROR;
+      take_sectors (sector, cnt);				// IMTC
+      *sectorp = sector;
     }
-  if (sector != BITMAP_ERROR)
-    *sectorp = sector;
+  lock_release (&free_map_lock);				// IMTC
   return sector != BITMAP_ERROR;
 }
 
+// IMTF
+/* Allocates up to CNT consecutive sectors as close to GOAL as
+   possible and stores the first into *SECTORP.  In order of
+   preference, takes the free sectors starting right at GOAL, so
+   that a file's last extent can simply grow; a run of CNT in
+   GOAL's allocation group; a run of CNT in the following groups;
+   and finally the first free run of any length.
+   Returns the number of sectors allocated, which is 0 if the
+   disk is full. */
+size_t
+free_map_allocate_near (block_sector_t goal, size_t cnt,
+                        block_sector_t *sectorp)
+{
+  size_t size = bitmap_size (free_map);
+  size_t start = BITMAP_ERROR, n, g, k;
+
+  if (cnt == 0)
+    return 0;
+  if (goal >= size)
+    goal = 0;
+
+  lock_acquire (&free_map_lock);
+  if (!bitmap_test (free_map, goal))
+    start = goal;
+
+  for (k = 0; k < group_cnt && start == BITMAP_ERROR; k++)
+  {
+    g = (goal / GROUP_SECTORS + k) % group_cnt;
+    if (group_free[g] >= cnt)
+      start = find_run (g * GROUP_SECTORS, (g + 1) * GROUP_SECTORS, cnt);
+  }
+
+  for (k = 0; k < group_cnt && start == BITMAP_ERROR; k++)
+  {
+    g = (goal / GROUP_SECTORS + k) % group_cnt;
+    if (group_free[g] > 0)
+      start = find_run (g * GROUP_SECTORS, (g + 1) * GROUP_SECTORS, 1);
+  }
+
+  if (start == BITMAP_ERROR)
+  {
+    lock_release (&free_map_lock);
+    return 0;
+  }
+
+  for (n = 1; n < cnt && start + n < size; n++)
+    if (bitmap_test (free_map, start + n))
+      break;
+
+  take_sectors (start, n);
+  lock_release (&free_map_lock);
+
+  *sectorp = start;
+  return n;
+}
+
 /* Makes CNT sectors starting at SECTOR available for use. */
 void
 free_map_release (block_sector_t sector, size_t cnt)
 {
+  lock_acquire (&free_map_lock);			// IMTC
   ASSERT (bitmap_all (free_map, sector, cnt));
   bitmap_set_multiple (free_map, sector, cnt, false);
-  bitmap_write (free_map, free_map_file);
+  mark_dirty (sector, cnt);			// IMTC
+  adjust_groups (sector, cnt, true);		// IMTC
+  lock_release (&free_map_lock);		// IMTC
 }
 
 /* Opens the free map file and reads it from disk. */
@@ -58,13 +167,33 @@ free_map_open (void)
     PANIC ("can't open free map");
   if (!bitmap_read (free_map, free_map_file))
     PANIC ("can't read free map");
+  count_groups ();							// IMTC
+  thread_create ("free-map", PRI_DEFAULT, free_map_flushd, NULL);	// IMTC
 }
 
-/* Writes the free map to disk and closes the free map file. */
+/* Writes the free map to disk and closes the free map file.
+   Later changes to the free map are no longer written, and the
+   flusher thread exits.  Closing the file trims its
+   preallocation, which frees sectors, so the final write goes
+   through a second handle opened after the close. */
 void
 free_map_close (void) 
 {
-  file_close (free_map_file);
+  struct file *file;			// IMTC
+
+  lock_acquire (&free_map_lock);	// IMTC
+  file = free_map_file;			// IMTC
+  free_map_file = NULL;			// IMTC
+  lock_release (&free_map_lock);	// IMTC
+  file_close (file);			// IMTC
+
+  file = file_open (inode_open (FREE_MAP_SECTOR));	// IMTC
+  if (file == NULL)					// IMTC
+    PANIC ("can't open free map");			// IMTC
+  lock_acquire (&free_map_lock);	// IMTC
+  flush_locked (file);			// IMTC
+  lock_release (&free_map_lock);	// IMTC
+  file_close (file);			// IMTC
 }
 
 /* Creates a new free map file on disk and writes the free map to
@@ -73,7 +202,7 @@ void
 free_map_create (void) 
 {
   /* Create inode. */
-  if (!inode_create (FREE_MAP_SECTOR, bitmap_file_size (free_map)))
+  if (!inode_create (FREE_MAP_SECTOR, bitmap_file_size (free_map), false))	// IMTC
     PANIC ("free map creation failed");
 
   /* Write bitmap to file. */
@@ -82,4 +211,150 @@ free_map_create (void)
     PANIC ("can't open free map");
   if (!bitmap_write (free_map, free_map_file))
     PANIC ("can't write free map");
+  bitmap_set_all (dirty_map, false);	// IMTC
+}
+
+// IMTF
+/* Writes the sectors of the free map file whose bits changed
+   since the last flush. */
+void
+free_map_flush (void)
+{
+  lock_acquire (&free_map_lock);
+  flush_locked (free_map_file);
+  lock_release (&free_map_lock);
+}
+
+// IMTF
+/* Marks the free map file sectors holding the bits for CNT
+   sectors starting at SECTOR as needing to be written.
+   Must be called with free_map_lock held. */
+static void
+mark_dirty (block_sector_t sector, size_t cnt)
+{
+  size_t first = sector / BITS_PER_SECTOR;
+  size_t last = (sector + cnt - 1) / BITS_PER_SECTOR;
+
+  if (cnt > 0)
+    bitmap_set_multiple (dirty_map, first, last - first + 1, true);
+}
+
+// IMTF
+/* Recomputes the free sector count of every allocation group. */
+static void
+count_groups (void)
+{
+  size_t size = bitmap_size (free_map);
+  size_t g;
+
+  for (g = 0; g < group_cnt; g++)
+  {
+    size_t start = g * GROUP_SECTORS;
+    size_t cnt = size - start < GROUP_SECTORS ? size - start : GROUP_SECTORS;
+
+    group_free[g] = bitmap_count (free_map, start, cnt, false);
+  }
+}
+
+// IMTF
+/* Marks the CNT free sectors starting at SECTOR as allocated.
+   Must be called with free_map_lock held. */
+static void
+take_sectors (block_sector_t sector, size_t cnt)
+{
+  bitmap_set_multiple (free_map, sector, cnt, true);
+  mark_dirty (sector, cnt);
+  adjust_groups (sector, cnt, false);
+  fsstat_count (NULL, FSSTAT_ALLOCATIONS, cnt);
+}
+
+// IMTF
+/* Updates the free counts of the allocation groups holding the
+   CNT sectors starting at SECTOR, which were just freed if FREED
+   is true or allocated otherwise.  Must be called with
+   free_map_lock held. */
+static void
+adjust_groups (block_sector_t sector, size_t cnt, bool freed)
+{
+  while (cnt > 0)
+  {
+    size_t g = sector / GROUP_SECTORS;
+    size_t n = (g + 1) * GROUP_SECTORS - sector;
+
+    if (n > cnt)
+      n = cnt;
+    if (freed)
+      group_free[g] += n;
+    else
+      group_free[g] -= n;
+    sector += n;
+    cnt -= n;
+  }
+}
+
+// IMTF
+/* Returns the first sector of the first run of CNT free sectors
+   that lies entirely within sectors START...END-1, or
+   BITMAP_ERROR if there is none.  Must be called with
+   free_map_lock held. */
+static size_t
+find_run (size_t start, size_t end, size_t cnt)
+{
+  size_t run = 0;
+  size_t i;
+
+  if (end > bitmap_size (free_map))
+    end = bitmap_size (free_map);
+
+  for (i = start; i < end; i++)
+    if (bitmap_test (free_map, i))
+      run = 0;
+    else if (++run == cnt)
+      return i - cnt + 1;
+
+  return BITMAP_ERROR;
+}
+
+// IMTF
+/* Writes out the dirty sectors of the free map through FILE,
+   which may be null to write nothing.  Must be called with
+   free_map_lock held. */
+static void
+flush_locked (struct file *file)
+{
+  size_t i;
+
+  if (file == NULL)
+    return;
+
+  for (i = 0; i < bitmap_size (dirty_map); i++)
+    if (bitmap_test (dirty_map, i))
+    {
+      if (!bitmap_write_part (free_map, file,
+                              i * BLOCK_SECTOR_SIZE, BLOCK_SECTOR_SIZE))
+	PANIC ("can't write free map");
+      bitmap_reset (dirty_map, i);
+      fsstat_count (NULL, FSSTAT_FREE_MAP_WRITES, 1);
+    }
+}
+
+// IMTF
+/* Thread that periodically writes the free map, so that a burst
+   of allocations and frees costs one write per changed sector.
+   Exits once the free map file has been closed. */
+static void
+free_map_flushd (void *aux UNUSED)
+{
+  for (;;)
+  {
+    bool open;
+
+    timer_sleep (FREE_MAP_FLUSH_INTERVAL);
+    lock_acquire (&free_map_lock);
+    flush_locked (free_map_file);
+    open = free_map_file != NULL;
+    lock_release (&free_map_lock);
+    if (!open)
+      return;
+  }
 }
@@ -0,0 +1,92 @@
+#include <stdio.h>
+#include "filesys/fsstat.h"
+#include "filesys/inode.h"
+#include "threads/interrupt.h"
+
+/* File system wide statistics. */
+static struct fsstat global_stat;
+
+/* Print the statistics at shutdown? */
+static bool print_stats;
+
+static const char *counter_names[FSSTAT_COUNTER_CNT] =
+  {
+    "bytes read",
+    "bytes written",
+    "sectors read",
+    "sectors written",
+    "cache hits",
+    "cache misses",
+    "dir lookups",
+    "allocations",
+    "free map writes",
+  };
+
+/* Adds N to COUNTER in ST, or in the global totals if ST is a
+   null pointer.  Safe to call from any thread. */
+void
+fsstat_count (struct fsstat *st, enum fsstat_counter counter,
+              unsigned long long n)
+{
+  enum intr_level old_level = intr_disable ();
+
+  if (st == NULL)
+    st = &global_stat;
+  st->counters[counter] += n;
+
+  intr_set_level (old_level);
+}
+
+/* Copies SRC, or the global totals if SRC is a null pointer,
+   into *DST. */
+void
+fsstat_get (struct fsstat *dst, const struct fsstat *src)
+{
+  enum intr_level old_level = intr_disable ();
+
+  *dst = src != NULL ? *src : global_stat;
+
+  intr_set_level (old_level);
+}
+
+/* Makes fsstat_print_stats() print the statistics when the
+   machine shuts down. */
+void
+fsstat_print_at_shutdown (void)
+{
+  print_stats = true;
+}
+
+/* Prints the global file system statistics, followed by those
+   of every inode in memory that has seen any I/O, if
+   fsstat_print_at_shutdown() has been called. */
+void
+fsstat_print_stats (void)
+{
+  int i;
+
+  if (!print_stats)
+    return;
+
+  for (i = 0; i < FSSTAT_COUNTER_CNT; i++)
+    printf ("FS: %llu %s\n", global_stat.counters[i], counter_names[i]);
+  inode_print_stats ();
+}
+
+/* Prints the nonzero counters of ST on one line after PREFIX. */
+void
+fsstat_print_counters (const char *prefix, const struct fsstat *st)
+{
+  bool first = true;
+  int i;
+
+  printf ("%s", prefix);
+  for (i = 0; i < FSSTAT_COUNTER_CNT; i++)
+    if (st->counters[i] != 0)
+    {
+      printf ("%s %llu %s", first ? "" : ",", st->counters[i],
+              counter_names[i]);
+      first = false;
+    }
+  printf ("\n");
+}
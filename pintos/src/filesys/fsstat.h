@@ -0,0 +1,14 @@
+#ifndef FILESYS_FSSTAT_H
+#define FILESYS_FSSTAT_H
+
+#include <stdbool.h>
+#include <fsstat.h>
+
+void fsstat_count (struct fsstat *, enum fsstat_counter,
+                   unsigned long long n);
+void fsstat_get (struct fsstat *dst, const struct fsstat *src);
+void fsstat_print_at_shutdown (void);
+void fsstat_print_stats (void);
+void fsstat_print_counters (const char *prefix, const struct fsstat *);
+
+#endif /* filesys/fsstat.h */
@@ -1,5 +1,7 @@
 #include "filesys/fsutil.h"
 #include <debug.h>
+#include <inttypes.h>		// IMTC
+#include <round.h>		// IMTC
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,10 +9,19 @@
 #include "filesys/directory.h"
 #include "filesys/file.h"
 #include "filesys/filesys.h"
+#include "filesys/fsstat.h"		// IMTC
+#include "devices/timer.h"		// IMTC
 #include "threads/malloc.h"
 #include "threads/palloc.h"
 #include "threads/vaddr.h"
 
+/* Sectors moved between the scratch device and a file at a time
+   by extract and append. */
+#define TRANSFER_SECTORS 64		// IMTC
+#define TRANSFER_SIZE (TRANSFER_SECTORS * BLOCK_SECTOR_SIZE)	// IMTC
+
+static void print_throughput (const char *, long long bytes, int64_t start);	// IMTC
+
 /* List files in the root directory. */
 void
 fsutil_ls (char **argv UNUSED) 
@@ -67,19 +78,33 @@ fsutil_rm (char **argv)
     PANIC ("%s: delete failed\n", file_name);
 }
 
+// IMTF
+/* Prints file system statistics, global and per inode, when the
+   machine shuts down. */
+void
+fsutil_fsstat (char **argv UNUSED)
+{
+  fsstat_print_at_shutdown ();
+}
+
 /* Extracts a ustar-format tar archive from the scratch block
-   device into the Pintos file system. */
+   device into the Pintos file system.  Each file's space is
+   reserved up front from the size in its header, and its data is
+   moved TRANSFER_SECTORS sectors at a time. */
 void
 fsutil_extract (char **argv UNUSED) 
 {
   static block_sector_t sector = 0;
 
   struct block *src;
-  void *header, *data;
+  void *header;
+  uint8_t *data;				// IMTC
+  long long total = 0;				// IMTC
+  int64_t start = timer_ticks ();		// IMTC
 
   /* Allocate buffers. */
   header = malloc (BLOCK_SECTOR_SIZE);
-  data = malloc (BLOCK_SECTOR_SIZE);
+  data = malloc (TRANSFER_SIZE);		// IMTC
   if (header == NULL || data == NULL)
     PANIC ("couldn't allocate buffers");
 
@@ -117,24 +142,29 @@ fsutil_extract (char **argv UNUSED)
 
           printf ("Putting '%s' into the file system...\n", file_name);
 
-          /* Create destination file. */
-          if (!filesys_create (file_name, size))
+          /* Create destination file and reserve its space, so
+             that it lands in as few runs on disk as possible.
+             Running out of space is caught by the writes. */
+          if (!filesys_create (file_name, 0))		// IMTC
             PANIC ("%s: create failed", file_name);
           dst = filesys_open (file_name);
           if (dst == NULL)
             PANIC ("%s: open failed", file_name);
+          file_reserve (dst, size);			// IMTC
 
           /* Do copy. */
           while (size > 0)
             {
-              int chunk_size = (size > BLOCK_SECTOR_SIZE
-                                ? BLOCK_SECTOR_SIZE
-                                : size);
-              block_read (src, sector++, data);
+              int chunk_size = size > TRANSFER_SIZE ? TRANSFER_SIZE : size;	// IMTC
+              int i;						// IMTC
+
+              for (i = 0; i * BLOCK_SECTOR_SIZE < chunk_size; i++)	// IMTC
+                block_read (src, sector++, data + i * BLOCK_SECTOR_SIZE);	// IMTC
               if (file_write (dst, data, chunk_size) != chunk_size)
                 PANIC ("%s: write failed with %d bytes unwritten",
                        file_name, size);
               size -= chunk_size;
+              total += chunk_size;				// IMTC
             }
 
           /* Finish up. */
@@ -151,6 +181,8 @@ fsutil_extract (char **argv UNUSED)
   block_write (src, 0, header);
   block_write (src, 1, header);
 
+  print_throughput ("Extracted", total, start);	// IMTC
+
   free (data);
   free (header);
 }
@@ -169,15 +201,17 @@ fsutil_append (char **argv)
   static block_sector_t sector = 0;
 
   const char *file_name = argv[1];
-  void *buffer;
+  uint8_t *buffer;				// IMTC
   struct file *src;
   struct block *dst;
   off_t size;
+  off_t total;					// IMTC
+  int64_t start = timer_ticks ();		// IMTC
 
   printf ("Appending '%s' to ustar archive on scratch device...\n", file_name);
 
   /* Allocate buffer. */
-  buffer = malloc (BLOCK_SECTOR_SIZE);
+  buffer = malloc (TRANSFER_SIZE);		// IMTC
   if (buffer == NULL)
     PANIC ("couldn't allocate buffer");
 
@@ -185,7 +219,7 @@ fsutil_append (char **argv)
   src = filesys_open (file_name);
   if (src == NULL)
     PANIC ("%s: open failed", file_name);
-  size = file_length (src);
+  size = total = file_length (src);		// IMTC
 
   /* Open target block device. */
   dst = block_get_role (BLOCK_SCRATCH);
@@ -193,20 +227,25 @@ fsutil_append (char **argv)
     PANIC ("couldn't open scratch device");
   
   /* Write ustar header to first sector. */
-  if (!ustar_make_header (file_name, USTAR_REGULAR, size, buffer))
+  if (!ustar_make_header (file_name, USTAR_REGULAR, size, (char *) buffer))	// IMTC
     PANIC ("%s: name too long for ustar format", file_name);
   block_write (dst, sector++, buffer);
 
   /* Do copy. */
   while (size > 0) 
     {
-      int chunk_size = size > BLOCK_SECTOR_SIZE ? BLOCK_SECTOR_SIZE : size;
-      if (sector >= block_size (dst))
+      int chunk_size = size > TRANSFER_SIZE ? TRANSFER_SIZE : size;	// IMTC
+      int sector_cnt = DIV_ROUND_UP (chunk_size, BLOCK_SECTOR_SIZE);	// IMTC
+      int i;							// IMTC
+
+      if (sector + sector_cnt > block_size (dst))		// IMTC
         PANIC ("%s: out of space on scratch device", file_name);
       if (file_read (src, buffer, chunk_size) != chunk_size)
         PANIC ("%s: read failed with %"PROTd" bytes unread", file_name, size);
-      memset (buffer + chunk_size, 0, BLOCK_SECTOR_SIZE - chunk_size);
-      block_write (dst, sector++, buffer);
+      memset (buffer + chunk_size, 0,				// IMTC
+              sector_cnt * BLOCK_SECTOR_SIZE - chunk_size);	// IMTC
+      for (i = 0; i < sector_cnt; i++)				// IMTC
+        block_write (dst, sector++, buffer + i * BLOCK_SECTOR_SIZE);	// IMTC
       size -= chunk_size;
     }
 
@@ -215,9 +254,25 @@ fsutil_append (char **argv)
      them, though, in case we have more files to append. */
   memset (buffer, 0, BLOCK_SECTOR_SIZE);
   block_write (dst, sector, buffer);
-  block_write (dst, sector, buffer + 1);
+  block_write (dst, sector + 1, buffer);		// IMTC
+
+  print_throughput ("Appended", total, start);	// IMTC
 
   /* Finish up. */
   file_close (src);
   free (buffer);
 }
+
+// IMTF
+/* Prints how many BYTES were moved since timer tick START, and
+   how fast, after VERB. */
+static void
+print_throughput (const char *verb, long long bytes, int64_t start)
+{
+  int64_t ticks = timer_elapsed (start);
+
+  if (ticks == 0)
+    ticks = 1;
+  printf ("%s %lld bytes in %"PRId64" ticks (%lld kB/s).\n",
+          verb, bytes, ticks, bytes * TIMER_FREQ / 1024 / ticks);
+}
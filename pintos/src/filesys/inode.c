@@ -1,23 +1,100 @@
 #include "filesys/inode.h"
 #include <list.h>
+#include <hash.h>		// IMTC
 #include <debug.h>
 #include <round.h>
+#include <stdio.h>		// IMTC
 #include <string.h>
+#include "filesys/cache.h"		// IMTC
 #include "filesys/filesys.h"
 #include "filesys/free-map.h"
+#include "filesys/fsstat.h"		// IMTC
+#include "devices/timer.h"		// IMTC
+#include "threads/interrupt.h"	// IMTC
 #include "threads/malloc.h"
+#include "threads/synch.h"		// IMTC
 
 /* Identifies an inode. */
 #define INODE_MAGIC 0x494e4f44
 
+/* Most closed inodes kept in memory for reopening. */
+#define CLOSED_INODE_MAX 64		// IMTC
+
+/* A sector's worth of zeros. */
+static char zeros[BLOCK_SECTOR_SIZE];	// IMTC
+
+/* Bounds on the number of sectors allocated beyond the end of a
+   growing file, so that a file written by small appends still
+   ends up in long runs on disk.  Sectors left over when the file
+   is last closed are given back. */
+#define PREALLOC_MIN 8			// IMTC
+#define PREALLOC_MAX 128		// IMTC
+
+/* Most tail buffers written back per pass of
+   inode_flush_tails() before it lets go of inode_table_lock. */
+#define TAIL_FLUSH_MAX 32		// IMTC
+
+/* A run of SECTOR_CNT consecutive disk sectors, starting at
+   DISK_SECTOR, that holds the file's sectors starting at
+   FILE_SECTOR. */
+// IMTS
+struct extent
+  {
+    uint32_t file_sector;               /* First sector within the file. */
+    block_sector_t disk_sector;         /* First sector on disk. */
+    uint32_t sector_cnt;                /* Number of sectors. */
+  };
+
+/* Extents are kept sorted by FILE_SECTOR.  The first
+   DIRECT_EXTENTS are stored in the inode itself.  The rest are
+   stored EXTENTS_PER_BLOCK to a sector in extent blocks, whose
+   sector numbers are listed in the inode's index sector and,
+   past the first INDEX_EXTENTS, in the index sectors listed in
+   its second-level index sector.  That makes room for MAX_EXTENTS
+   extents, so even a file whose every sector is an extent of its
+   own can grow to over 300 MB; a write that would need more
+   extents comes up short, like one that finds the disk full. */
+#define DIRECT_EXTENTS 40				// IMTC
+#define EXTENTS_PER_BLOCK 42				// IMTC
+#define INDEX_CNT (BLOCK_SECTOR_SIZE / sizeof (block_sector_t))	// IMTC
+#define INDEX_EXTENTS (INDEX_CNT * EXTENTS_PER_BLOCK)	// IMTC
+#define MAX_EXTENTS (DIRECT_EXTENTS + INDEX_EXTENTS + INDEX_CNT * INDEX_EXTENTS)	// IMTC
+
+/* Files of up to INLINE_MAX bytes keep their data in the inode
+   sector itself, in place of the direct extents, so that reading
+   one takes no disk access beyond the inode.  A file that grows
+   past INLINE_MAX moves its data out to a sector of its own. */
+#define INLINE_MAX (DIRECT_EXTENTS * sizeof (struct extent))	// IMTC
+
+/* Inode flags. */
+#define INODE_INLINE 0x1        /* Data is stored inline. */	// IMTC
+#define INODE_DIR 0x2           /* Inode holds a directory. */	// IMTC
+
 /* On-disk inode.
    Must be exactly BLOCK_SECTOR_SIZE bytes long. */
 struct inode_disk
   {
-    block_sector_t start;               /* First data sector. */
     off_t length;                       /* File size in bytes. */
     unsigned magic;                     /* Magic number. */
-    uint32_t unused[125];               /* Not used. */
+    uint32_t extent_cnt;                /* Number of extents. */
+    block_sector_t index;               /* Extent block index, or 0. */
+    union					// IMTC
+      {
+        struct extent extents[DIRECT_EXTENTS];  /* First extents. */
+        uint8_t inline_data[INLINE_MAX];        /* Inline file data. */	// IMTC
+      };
+    uint32_t flags;                     /* INODE_* flags. */	// IMTC
+    block_sector_t index2;              /* Index of extent block indexes, or 0. */	// IMTC
+    uint32_t unused[2];                 /* Not used. */	// IMTC
+  };
+
+/* Indirect block of extents.
+   Must be exactly BLOCK_SECTOR_SIZE bytes long. */
+// IMTS
+struct extent_block
+  {
+    struct extent extents[EXTENTS_PER_BLOCK];
+    uint32_t unused[2];                 /* Not used. */
   };
 
 /* Returns the number of sectors to allocate for an inode SIZE
@@ -28,49 +105,156 @@ bytes_to_sectors (off_t size)
   return DIV_ROUND_UP (size, BLOCK_SECTOR_SIZE);
 }
 
-/* In-memory inode. */
+/* In-memory inode.
+
+   OPEN_CNT, REMOVED, LOADING and the table links are protected
+   by inode_table_lock.  While LOADING is true the inode is in
+   the table but DATA is still being read from disk, without
+   inode_table_lock held; anyone else opening it waits on
+   LOADED.  RW protects DATA, DENY_WRITE_CNT and the
+   tail buffer: reads of the file hold it shared and writes hold
+   it exclusive, so any number of threads may read one file at a
+   time.  DIR_LOCK
+   serializes changes to a directory's entries and protects
+   LISTING_CNT; neither is used for ordinary files. */
 struct inode 
   {
-    struct list_elem elem;              /* Element in inode list. */
+    struct hash_elem elem;              /* Element in inode table. */	// IMTC
+    struct list_elem lru_elem;          /* Element in closed_inodes. */	// IMTC
     block_sector_t sector;              /* Sector number of disk location. */
     int open_cnt;                       /* Number of openers. */
+    bool loading;                       /* DATA not read in yet? */	// IMTC
+    struct condition loaded;            /* Signaled when LOADING clears. */	// IMTC
     bool removed;                       /* True if deleted, false otherwise. */
     int deny_write_cnt;                 /* 0: writes ok, >0: deny writes. */
+    struct rwlock rw;                   /* Readers-writer lock on data. */	// IMTC
+    struct lock dir_lock;               /* Lock for directory entries. */	// IMTC
+    int listing_cnt;                    /* Open handles listing entries. */	// IMTC
     struct inode_disk data;             /* Inode content. */
+    struct extent hint;                 /* Extent of the last lookup. */
+    struct fsstat stat;                 /* I/O statistics. */	// IMTC
+    uint8_t *tail;                      /* Unwritten last sector, or null. */	// IMTC
+    uint32_t tail_sector;               /* File sector TAIL holds. */	// IMTC
+    block_sector_t tail_disk;           /* Disk sector TAIL belongs in. */	// IMTC
+    int64_t tail_time;                  /* Timer tick TAIL was started. */	// IMTC
   };
 
+static void get_extent (struct inode_disk *, size_t idx, struct extent *);	// IMTC
+static bool set_extent (struct inode_disk *, size_t idx, const struct extent *);	// IMTC
+static bool insert_extent (struct inode_disk *, size_t idx, const struct extent *);	// IMTC
+static size_t fill_hole (struct inode *, uint32_t sector, size_t cnt, bool append);	// IMTC
+static void release_sectors (struct inode_disk *);		// IMTC
+static void walk_index (block_sector_t, int nested, void (*) (block_sector_t));	// IMTC
+static void release_block (block_sector_t);			// IMTC
+static void flush_block (block_sector_t);			// IMTC
+static void trim_sectors (struct inode *);			// IMTC
+static void zero_range (struct inode *, off_t start, off_t end);	// IMTC
+static bool move_inline_data (struct inode *);			// IMTC
+static void count_lookup (struct inode *, bool hit, bool read);	// IMTC
+static off_t write_tail (struct inode *, const uint8_t *, off_t size, off_t offset);	// IMTC
+static bool start_tail (struct inode *, off_t offset);		// IMTC
+static void flush_tail (struct inode *, bool sync);		// IMTC
+
+// IMTF
+/* Returns the block device sector that holds file sector SECTOR
+   of INODE, or -1 if no disk sector is allocated for it.  Unlike
+   byte_to_sector(), does not check INODE's length, so it also
+   finds sectors preallocated past end of file. */
+static block_sector_t
+lookup_sector (struct inode *inode, uint32_t sector)
+{
+  struct extent hint, *h = &hint;
+  enum intr_level old_level;
+  size_t lo, hi;
+
+  if (inode->data.extent_cnt == 0)
+    return -1;
+
+  /* Sequential access usually stays within the last extent.
+     Concurrent readers share the hint, so copy it atomically. */
+  old_level = intr_disable ();
+  hint = inode->hint;
+  intr_set_level (old_level);
+  if (sector - h->file_sector < h->sector_cnt)
+    return h->disk_sector + (sector - h->file_sector);
+
+  /* Otherwise binary search for the last extent that starts at
+     or before SECTOR.  SECTOR is in a hole if that extent ends
+     before it, or if there is no such extent. */
+  lo = 0;
+  hi = inode->data.extent_cnt;
+  while (hi - lo > 1)
+  {
+    size_t mid = (lo + hi) / 2;
+    struct extent e;
+
+    get_extent (&inode->data, mid, &e);
+    if (e.file_sector <= sector)
+      lo = mid;
+    else
+      hi = mid;
+  }
+  get_extent (&inode->data, lo, h);
+  if (sector - h->file_sector >= h->sector_cnt)
+    return -1;
+
+  old_level = intr_disable ();
+  inode->hint = hint;
+  intr_set_level (old_level);
+  return h->disk_sector + (sector - h->file_sector);
+}
+
 /* Returns the block device sector that contains byte offset POS
    within INODE.
    Returns -1 if INODE does not contain data for a byte at offset
-   POS. */
+   POS, either because POS is past end of file or because it lies
+   in a hole, which reads as zeros. */
 static block_sector_t
-byte_to_sector (const struct inode *inode, off_t pos) 
+byte_to_sector (struct inode *inode, off_t pos) 	// IMTC
 {
   ASSERT (inode != NULL);
-  if (pos < inode->data.length)
-    return inode->data.start + pos / BLOCK_SECTOR_SIZE;
-  else
+  if (pos >= inode->data.length)			// IMTC
     return -1;
+  return lookup_sector (inode, pos / BLOCK_SECTOR_SIZE);	// IMTC
 }
 
-/* List of open inodes, so that opening a single inode twice
-   returns the same `struct inode'. */
-static struct list open_inodes;
+/* Table of in-memory inodes, keyed by sector, so that opening a
+   single inode twice returns the same `struct inode'.  It also
+   holds recently closed inodes, so that reopening them does not
+   read the disk again. */
+static struct hash inode_table;		// IMTC
+
+/* Closed inodes still in INODE_TABLE, most recently closed
+   first. */
+static struct list closed_inodes;	// IMTC
+
+/* Protects INODE_TABLE, CLOSED_INODES and the open counts and
+   removal flags of all inodes. */
+static struct lock inode_table_lock;	// IMTC
+
+static unsigned inode_hash (const struct hash_elem *, void *);	// IMTC
+static bool inode_less (const struct hash_elem *, const struct hash_elem *, void *);	// IMTC
+static bool evict_closed_inode (void);				// IMTC
 
 /* Initializes the inode module. */
 void
 inode_init (void) 
 {
-  list_init (&open_inodes);
+  hash_init (&inode_table, inode_hash, inode_less, NULL);	// IMTC
+  list_init (&closed_inodes);					// IMTC
+  lock_init (&inode_table_lock);				// IMTC
 }
 
 /* Initializes an inode with LENGTH bytes of data and
    writes the new inode to sector SECTOR on the file system
-   device.
+   device, marking it as a directory if IS_DIR is true.
+   The data starts out as zeros, stored inline if it is
+   small enough and as a hole otherwise; disk sectors are
+   allocated only when they are first written.
    Returns true if successful.
-   Returns false if memory or disk allocation fails. */
+   Returns false if memory allocation fails. */
 bool
-inode_create (block_sector_t sector, off_t length)
+inode_create (block_sector_t sector, off_t length, bool is_dir)	// IMTC
 {
   struct inode_disk *disk_inode = NULL;
   bool success = false;
@@ -80,26 +264,19 @@ inode_create (block_sector_t sector, off_t length)
   /* If this assertion fails, the inode structure is not exactly
      one sector in size, and you should fix that. */
   ASSERT (sizeof *disk_inode == BLOCK_SECTOR_SIZE);
+  ASSERT (sizeof (struct extent_block) == BLOCK_SECTOR_SIZE);	// IMTC
 
   disk_inode = calloc (1, sizeof *disk_inode);
   if (disk_inode != NULL)
     {
-      size_t sectors = bytes_to_sectors (length);
       disk_inode->length = length;
       disk_inode->magic = INODE_MAGIC;
-      if (free_map_allocate (sectors, &disk_inode->start)) 
-        {
-          block_write (fs_device, sector, disk_inode);
-          if (sectors > 0) 
-            {
-              static char zeros[BLOCK_SECTOR_SIZE];
-              size_t i;
-              
-              for (i = 0; i < sectors; i++) 
-                block_write (fs_device, disk_inode->start + i, zeros);
-            }
-          success = true; 
-        } 
+      if (length <= (off_t) INLINE_MAX)			// IMTC
+        disk_inode->flags |= INODE_INLINE;		// IMTC
+      if (is_dir)					// IMTC
+        disk_inode->flags |= INODE_DIR;			// IMTC
+      cache_write (sector, disk_inode, 0, BLOCK_SECTOR_SIZE);	// IMTC
+      success = true; 
       free (disk_inode);
     }
   return success;
@@ -111,33 +288,58 @@ inode_create (block_sector_t sector, off_t length)
 struct inode *
 inode_open (block_sector_t sector)
 {
-  struct list_elem *e;
+  struct inode key;			// IMTC
+  struct hash_elem *e;			// IMTC
   struct inode *inode;
 
-  /* Check whether this inode is already open. */
-  for (e = list_begin (&open_inodes); e != list_end (&open_inodes);
-       e = list_next (e)) 
+  /* Check whether this inode is already in memory. */
+  lock_acquire (&inode_table_lock);	// IMTC
+  key.sector = sector;			// IMTC
+  e = hash_find (&inode_table, &key.elem);	// IMTC
+  if (e != NULL)			// IMTC
     {
-      inode = list_entry (e, struct inode, elem);
-      if (inode->sector == sector) 
-        {
-          inode_reopen (inode);
-          return inode; 
-        }
+      inode = hash_entry (e, struct inode, elem);	// IMTC
+      if (inode->open_cnt++ == 0)	// IMTC
+        list_remove (&inode->lru_elem);	// IMTC
+      while (inode->loading)		// IMTC
+        cond_wait (&inode->loaded, &inode_table_lock);	// IMTC
+      lock_release (&inode_table_lock);	// IMTC
+      return inode; 
     }
 
-  /* Allocate memory. */
-  inode = malloc (sizeof *inode);
-  if (inode == NULL)
-    return NULL;
+  /* Allocate memory, dropping closed inodes if memory is short. */
+  while ((inode = malloc (sizeof *inode)) == NULL)	// IMTC
+    if (!evict_closed_inode ())		// IMTC
+      {
+        lock_release (&inode_table_lock);	// IMTC
+        return NULL;
+      }
 
-  /* Initialize. */
-  list_push_front (&open_inodes, &inode->elem);
+  /* Initialize.  The inode goes into the table marked as
+     loading, so that the table can be unlocked while it is read
+     from disk; anyone else opening it meanwhile waits for the
+     read to finish. */
   inode->sector = sector;
+  hash_insert (&inode_table, &inode->elem);	// IMTC
   inode->open_cnt = 1;
   inode->deny_write_cnt = 0;
   inode->removed = false;
-  block_read (fs_device, inode->sector, &inode->data);
+  inode->hint.sector_cnt = 0;		// IMTC
+  memset (&inode->stat, 0, sizeof inode->stat);	// IMTC
+  inode->tail = NULL;			// IMTC
+  rw_init (&inode->rw);			// IMTC
+  lock_init (&inode->dir_lock);		// IMTC
+  inode->listing_cnt = 0;		// IMTC
+  inode->loading = true;		// IMTC
+  cond_init (&inode->loaded);		// IMTC
+  lock_release (&inode_table_lock);	// IMTC
+
+  cache_read (inode->sector, &inode->data, 0, BLOCK_SECTOR_SIZE);	// IMTC
+
+  lock_acquire (&inode_table_lock);	// IMTC
+  inode->loading = false;		// IMTC
+  cond_broadcast (&inode->loaded, &inode_table_lock);	// IMTC
+  lock_release (&inode_table_lock);	// IMTC
   return inode;
 }
 
@@ -146,7 +348,11 @@ struct inode *
 inode_reopen (struct inode *inode)
 {
   if (inode != NULL)
-    inode->open_cnt++;
+    {
+      lock_acquire (&inode_table_lock);	// IMTC
+      inode->open_cnt++;
+      lock_release (&inode_table_lock);	// IMTC
+    }
   return inode;
 }
 
@@ -157,9 +363,18 @@ inode_get_inumber (const struct inode *inode)
   return inode->sector;
 }
 
+// IMTF
+/* Returns true if INODE holds a directory. */
+bool
+inode_is_dir (const struct inode *inode)
+{
+  return (inode->data.flags & INODE_DIR) != 0;
+}
+
 /* Closes INODE and writes it to disk.
-   If this was the last reference to INODE, frees its memory.
-   If INODE was also a removed inode, frees its blocks. */
+   If this was the last reference to INODE, keeps it in memory
+   among the recently closed inodes, unless INODE was also a
+   removed inode, in which case frees its memory and its blocks. */
 void
 inode_close (struct inode *inode) 
 {
@@ -167,22 +382,36 @@ inode_close (struct inode *inode)
   if (inode == NULL)
     return;
 
+  /* Put appended data still held in memory into the cache. */
+  if (inode->tail != NULL)		// IMTC
+    {
+      rw_write_acquire (&inode->rw);	// IMTC
+      flush_tail (inode, false);	// IMTC
+      rw_write_release (&inode->rw);	// IMTC
+    }
+
   /* Release resources if this was the last opener. */
+  lock_acquire (&inode_table_lock);	// IMTC
   if (--inode->open_cnt == 0)
     {
-      /* Remove from inode list and release lock. */
-      list_remove (&inode->elem);
- 
-      /* Deallocate blocks if removed. */
+      /* Deallocate blocks if removed.  Nobody can find the inode
+         once it is out of the table, so this needs no lock. */
       if (inode->removed) 
         {
+          hash_delete (&inode_table, &inode->elem);	// IMTC
+          lock_release (&inode_table_lock);	// IMTC
           free_map_release (inode->sector, 1);
-          free_map_release (inode->data.start,
-                            bytes_to_sectors (inode->data.length)); 
+          release_sectors (&inode->data);	// IMTC
+          free (inode);				// IMTC
+          return;				// IMTC
         }
 
-      free (inode); 
+      trim_sectors (inode);					// IMTC
+      list_push_front (&closed_inodes, &inode->lru_elem);	// IMTC
+      if (list_size (&closed_inodes) > CLOSED_INODE_MAX)	// IMTC
+        evict_closed_inode ();					// IMTC
     }
+  lock_release (&inode_table_lock);	// IMTC
 }
 
 /* Marks INODE to be deleted when it is closed by the last caller who
@@ -191,7 +420,59 @@ void
 inode_remove (struct inode *inode) 
 {
   ASSERT (inode != NULL);
+  lock_acquire (&inode_table_lock);	// IMTC
   inode->removed = true;
+  lock_release (&inode_table_lock);	// IMTC
+}
+
+// IMTF
+/* Acquires INODE's directory lock, which serializes lookups
+   and changes to the entries of the directory stored in it. */
+void
+inode_lock_dir (struct inode *inode)
+{
+  lock_acquire (&inode->dir_lock);
+}
+
+// IMTF
+/* Releases INODE's directory lock. */
+void
+inode_unlock_dir (struct inode *inode)
+{
+  lock_release (&inode->dir_lock);
+}
+
+// IMTF
+/* Notes that an open handle has started listing the entries of
+   directory INODE.  Until the matching inode_end_listing(),
+   the directory's entries stay where they are. */
+void
+inode_begin_listing (struct inode *inode)
+{
+  lock_acquire (&inode->dir_lock);
+  inode->listing_cnt++;
+  lock_release (&inode->dir_lock);
+}
+
+// IMTF
+/* Notes that a handle listing directory INODE has been closed. */
+void
+inode_end_listing (struct inode *inode)
+{
+  lock_acquire (&inode->dir_lock);
+  ASSERT (inode->listing_cnt > 0);
+  inode->listing_cnt--;
+  lock_release (&inode->dir_lock);
+}
+
+// IMTF
+/* Returns true if any open handle is listing directory INODE.
+   The caller must hold INODE's directory lock. */
+bool
+inode_is_listed (struct inode *inode)
+{
+  ASSERT (lock_held_by_current_thread (&inode->dir_lock));
+  return inode->listing_cnt > 0;
 }
 
 /* Reads SIZE bytes from INODE into BUFFER, starting at position OFFSET.
@@ -202,8 +483,22 @@ inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset)
 {
   uint8_t *buffer = buffer_;
   off_t bytes_read = 0;
-  uint8_t *bounce = NULL;
 
+  ASSERT (offset >= 0);			// IMTC
+
+  rw_read_acquire (&inode->rw);		// IMTC
+  if (inode->data.flags & INODE_INLINE)	// IMTC
+    {
+      /* Copy straight out of the in-memory inode. */
+      if (offset < inode->data.length)		// IMTC
+        {
+          bytes_read = inode->data.length - offset;	// IMTC
+          if (bytes_read > size)		// IMTC
+            bytes_read = size;			// IMTC
+          memcpy (buffer, inode->data.inline_data + offset, bytes_read);	// IMTC
+        }
+      size = 0;				// IMTC
+    }
   while (size > 0) 
     {
       /* Disk sector to read, starting byte offset within sector. */
@@ -220,110 +515,1064 @@ inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset)
       if (chunk_size <= 0)
         break;
 
-      if (sector_ofs == 0 && chunk_size == BLOCK_SECTOR_SIZE)
-        {
-          /* Read full sector directly into caller's buffer. */
-          block_read (fs_device, sector_idx, buffer + bytes_read);
-        }
-      else 
-        {
-          /* Read sector into bounce buffer, then partially copy
-             into caller's buffer. */
-          if (bounce == NULL) 
-            {
-              bounce = malloc (BLOCK_SECTOR_SIZE);
-              if (bounce == NULL)
-                break;
-            }
-          block_read (fs_device, sector_idx, bounce);
-          memcpy (buffer + bytes_read, bounce + sector_ofs, chunk_size);
-        }
+      /* Copy the chunk out of the tail buffer if it is there,
+         the buffer cache otherwise, or zeros if it lies in a
+         hole. */
+      if (inode->tail != NULL				// IMTC
+          && offset / BLOCK_SECTOR_SIZE == (off_t) inode->tail_sector)	// IMTC
+        memcpy (buffer + bytes_read, inode->tail + sector_ofs, chunk_size);	// IMTC
+      else if (sector_idx == (block_sector_t) -1)	// IMTC
+        memset (buffer + bytes_read, 0, chunk_size);	// IMTC
+      else						// IMTC
+        count_lookup (inode, cache_read (sector_idx, buffer + bytes_read,	// IMTC
+                                         sector_ofs, chunk_size), true);	// IMTC
       
       /* Advance. */
       size -= chunk_size;
       offset += chunk_size;
       bytes_read += chunk_size;
     }
-  free (bounce);
+  inode_count (inode, FSSTAT_BYTES_READ, bytes_read);	// IMTC
+  rw_read_release (&inode->rw);		// IMTC
 
   return bytes_read;
 }
 
+// IMTF
+/* Queues the sectors holding LENGTH bytes of INODE starting at
+   OFFSET, up to end of file, to be read into the buffer cache in
+   the background.  Holes are skipped.  Stops at the first sector
+   the cache has no room to queue, returning its offset;
+   otherwise returns OFFSET + LENGTH. */
+off_t
+inode_read_ahead (struct inode *inode, off_t offset, off_t length)
+{
+  off_t end = offset + length;
+  off_t pos, stop;
+
+  rw_read_acquire (&inode->rw);
+  stop = end < inode_length (inode) ? end : inode_length (inode);
+
+  for (pos = ROUND_DOWN (offset, BLOCK_SECTOR_SIZE); pos < stop;
+       pos += BLOCK_SECTOR_SIZE)
+  {
+    block_sector_t sector = byte_to_sector (inode, pos);
+
+    if (sector != (block_sector_t) -1 && !cache_read_ahead (sector))
+    {
+      end = pos > offset ? pos : offset;
+      break;
+    }
+  }
+  rw_read_release (&inode->rw);
+
+  return end;
+}
+
+// IMTF
+/* Writes INODE's dirty cached sectors back to disk: its data,
+   its extent blocks, and last the inode itself. */
+void
+inode_flush (struct inode *inode)
+{
+  struct inode_disk *disk = &inode->data;
+  size_t i;
+
+  rw_write_acquire (&inode->rw);
+  flush_tail (inode, false);
+  rw_write_release (&inode->rw);
+
+  rw_read_acquire (&inode->rw);
+  for (i = 0; i < disk->extent_cnt; i++)
+  {
+    struct extent e;
+
+    get_extent (disk, i, &e);
+    cache_flush_range (e.disk_sector, e.sector_cnt);
+  }
+
+  walk_index (disk->index, 0, flush_block);
+  walk_index (disk->index2, 1, flush_block);
+
+  cache_flush_range (inode->sector, 1);
+  rw_read_release (&inode->rw);
+}
+
+// IMTF
+/* Writes the tail buffers of open inodes that were started at
+   timer tick DEADLINE or earlier through to disk, so that data
+   appended a little at a time does not sit in memory for long.
+   Called periodically by the buffer cache's flusher thread. */
+void
+inode_flush_tails (int64_t deadline)
+{
+  struct inode *batch[TAIL_FLUSH_MAX];
+  int cnt, i;
+
+  do
+  {
+    struct hash_iterator it;
+
+    /* Hold a reference to each inode to flush, so that it stays
+       in memory once inode_table_lock is released. */
+    cnt = 0;
+    lock_acquire (&inode_table_lock);
+    hash_first (&it, &inode_table);
+    while (cnt < TAIL_FLUSH_MAX && hash_next (&it))
+    {
+      struct inode *inode = hash_entry (hash_cur (&it), struct inode, elem);
+
+      if (inode->open_cnt > 0 && inode->tail != NULL
+          && inode->tail_time <= deadline)
+      {
+	inode->open_cnt++;
+	batch[cnt++] = inode;
+      }
+    }
+    lock_release (&inode_table_lock);
+
+    for (i = 0; i < cnt; i++)
+    {
+      struct inode *inode = batch[i];
+
+      rw_write_acquire (&inode->rw);
+      if (inode->tail != NULL && inode->tail_time <= deadline)
+	flush_tail (inode, true);
+      rw_write_release (&inode->rw);
+      inode_close (inode);
+    }
+  }
+  while (cnt == TAIL_FLUSH_MAX);
+}
+
+// IMTF
+/* Adds N to COUNTER in INODE's statistics and in the global
+   totals. */
+void
+inode_count (struct inode *inode, enum fsstat_counter counter,
+             unsigned long long n)
+{
+  fsstat_count (&inode->stat, counter, n);
+  fsstat_count (NULL, counter, n);
+}
+
+// IMTF
+/* Copies INODE's statistics into *ST. */
+void
+inode_get_stat (struct inode *inode, struct fsstat *st)
+{
+  fsstat_get (st, &inode->stat);
+}
+
+// IMTF
+/* Prints the statistics of every inode in memory, open or
+   recently closed, that has counted anything. */
+void
+inode_print_stats (void)
+{
+  struct hash_iterator i;
+
+  lock_acquire (&inode_table_lock);
+  hash_first (&i, &inode_table);
+  while (hash_next (&i))
+  {
+    struct inode *inode = hash_entry (hash_cur (&i), struct inode, elem);
+    struct fsstat st;
+    char prefix[32];
+    int j;
+
+    if (inode->loading)
+      continue;
+    fsstat_get (&st, &inode->stat);
+    for (j = 0; j < FSSTAT_COUNTER_CNT; j++)
+      if (st.counters[j] != 0)
+	break;
+    if (j == FSSTAT_COUNTER_CNT)
+      continue;
+
+    snprintf (prefix, sizeof prefix, "FS: inode %"PRDSNu"%s:",
+              inode->sector, inode_is_dir (inode) ? " (dir)" : "");
+    fsstat_print_counters (prefix, &st);
+  }
+  lock_release (&inode_table_lock);
+}
+
+// IMTF
+/* Counts, in INODE's statistics, a lookup of a data sector in
+   the buffer cache by a read if READ is true or by a write
+   otherwise.  A read that missed went to disk.  The global
+   totals are kept by the cache itself. */
+static void
+count_lookup (struct inode *inode, bool hit, bool read)
+{
+  fsstat_count (&inode->stat, hit ? FSSTAT_CACHE_HITS : FSSTAT_CACHE_MISSES, 1);
+  if (!hit && read)
+    fsstat_count (&inode->stat, FSSTAT_SECTORS_READ, 1);
+}
+
+// IMTF
+/* Reads SIZE bytes from INODE into BUFFER, starting at OFFSET,
+   straight from the disk into BUFFER without going through the
+   buffer cache.  OFFSET and SIZE must be multiples of
+   BLOCK_SECTOR_SIZE, and BUFFER must have room for SIZE bytes.
+   Returns the number of bytes read, which is less than SIZE at
+   end of file.  The rest of the last sector read is zeroed in
+   BUFFER, whether INODE keeps its data inline or in sectors. */
+off_t
+inode_read_direct (struct inode *inode, void *buffer_, off_t size,
+                   off_t offset)
+{
+  uint8_t *buffer = buffer_;
+  off_t bytes_read;
+
+  ASSERT (offset >= 0);
+  ASSERT (offset % BLOCK_SECTOR_SIZE == 0 && size % BLOCK_SECTOR_SIZE == 0);
+
+  rw_read_acquire (&inode->rw);
+  if (inode->data.flags & INODE_INLINE)
+  {
+    rw_read_release (&inode->rw);
+    bytes_read = inode_read_at (inode, buffer, size, offset);
+    if (bytes_read % BLOCK_SECTOR_SIZE != 0)
+      memset (buffer + bytes_read, 0,
+              BLOCK_SECTOR_SIZE - bytes_read % BLOCK_SECTOR_SIZE);
+    return bytes_read;
+  }
+
+  if (offset >= inode_length (inode))
+    size = 0;
+  else if (size > inode_length (inode) - offset)
+    size = inode_length (inode) - offset;
+
+  for (bytes_read = 0; bytes_read < size; bytes_read += BLOCK_SECTOR_SIZE)
+  {
+    block_sector_t sector = lookup_sector (inode, (offset + bytes_read)
+                                                  / BLOCK_SECTOR_SIZE);
+
+    if (inode->tail != NULL
+        && (offset + bytes_read) / BLOCK_SECTOR_SIZE
+           == (off_t) inode->tail_sector)
+      memcpy (buffer + bytes_read, inode->tail, BLOCK_SECTOR_SIZE);
+    else if (sector == (block_sector_t) -1)
+      memset (buffer + bytes_read, 0, BLOCK_SECTOR_SIZE);
+    else
+    {
+      cache_read_direct (sector, buffer + bytes_read);
+      fsstat_count (&inode->stat, FSSTAT_SECTORS_READ, 1);
+    }
+  }
+  inode_count (inode, FSSTAT_BYTES_READ, size);
+
+  /* Don't hand out whatever follows end of file in its sector. */
+  if (size % BLOCK_SECTOR_SIZE != 0)
+    memset (buffer + size, 0, BLOCK_SECTOR_SIZE - size % BLOCK_SECTOR_SIZE);
+  rw_read_release (&inode->rw);
+
+  return size;
+}
+
+// IMTF
+/* Writes SIZE bytes from BUFFER into INODE, starting at OFFSET,
+   straight to the disk without going through the buffer cache.
+   OFFSET and SIZE must be multiples of BLOCK_SECTOR_SIZE.
+   Allocates sectors and extends INODE as inode_write_at() does.
+   Returns the number of bytes written, which is less than SIZE
+   if the disk fills up. */
+off_t
+inode_write_direct (struct inode *inode, const void *buffer_, off_t size,
+                    off_t offset)
+{
+  const uint8_t *buffer = buffer_;
+  off_t bytes_written = 0;
+  off_t old_length;
+  bool changed = false;
+
+  ASSERT (offset >= 0);
+  ASSERT (offset % BLOCK_SECTOR_SIZE == 0 && size % BLOCK_SECTOR_SIZE == 0);
+
+  rw_write_acquire (&inode->rw);
+  if (inode->deny_write_cnt)
+  {
+    rw_write_release (&inode->rw);
+    return 0;
+  }
+  if (inode->data.flags & INODE_INLINE)
+  {
+    rw_write_release (&inode->rw);
+    return inode_write_at (inode, buffer, size, offset);
+  }
+  flush_tail (inode, false);
+
+  old_length = inode->data.length;
+  if (size > 0 && offset > old_length)
+    zero_range (inode, old_length, offset);
+
+  while (bytes_written < size)
+  {
+    uint32_t file_sector = (offset + bytes_written) / BLOCK_SECTOR_SIZE;
+    block_sector_t sector = lookup_sector (inode, file_sector);
+
+    /* Every fresh sector is overwritten in full, so none needs
+       zeroing. */
+    if (sector == (block_sector_t) -1)
+    {
+      if (fill_hole (inode, file_sector,
+                     (size - bytes_written) / BLOCK_SECTOR_SIZE,
+                     offset + size > old_length) == 0)
+	break;
+      changed = true;
+      continue;
+    }
+
+    cache_write_direct (sector, buffer + bytes_written);
+    fsstat_count (&inode->stat, FSSTAT_SECTORS_WRITTEN, 1);
+    bytes_written += BLOCK_SECTOR_SIZE;
+  }
+  inode_count (inode, FSSTAT_BYTES_WRITTEN, bytes_written);
+
+  if (offset + bytes_written > inode->data.length)
+  {
+    inode->data.length = offset + bytes_written;
+    changed = true;
+  }
+  if (changed)
+    cache_write (inode->sector, &inode->data, 0, BLOCK_SECTOR_SIZE);
+  rw_write_release (&inode->rw);
+
+  return bytes_written;
+}
+
+// IMTF
+/* Allocates disk sectors for INODE to grow into until it is
+   LENGTH bytes long, as few and as long runs as possible, without
+   changing its length.  Sectors left unused when INODE is last
+   closed are given back.  Returns false if the disk fills up
+   first. */
+bool
+inode_reserve (struct inode *inode, off_t length)
+{
+  uint32_t sector, end = bytes_to_sectors (length);
+  bool changed = false;
+  bool success = true;
+
+  if (length <= (off_t) INLINE_MAX)
+    return true;
+
+  rw_write_acquire (&inode->rw);
+  flush_tail (inode, false);
+  if ((inode->data.flags & INODE_INLINE) && !move_inline_data (inode))
+    success = false;
+
+  for (sector = 0; success && sector < end; )
+    if (lookup_sector (inode, sector) != (block_sector_t) -1)
+      sector++;
+    else
+    {
+      size_t n = fill_hole (inode, sector, end - sector, false);
+
+      if (n == 0)
+	success = false;
+      sector += n;
+      changed = true;
+    }
+
+  if (changed)
+    cache_write (inode->sector, &inode->data, 0, BLOCK_SECTOR_SIZE);
+  rw_write_release (&inode->rw);
+
+  return success;
+}
+
 /* Writes SIZE bytes from BUFFER into INODE, starting at OFFSET.
    Returns the number of bytes actually written, which may be
-   less than SIZE if end of file is reached or an error occurs.
-   (Normally a write at end of file would extend the inode, but
-   growth is not yet implemented.) */
+   less than SIZE if the disk fills up or an error occurs.
+   A write past end of file extends the inode, leaving a hole
+   between the old end of file and OFFSET.  Disk sectors are
+   allocated as the write reaches holes. */
 off_t
 inode_write_at (struct inode *inode, const void *buffer_, off_t size,
                 off_t offset) 
 {
   const uint8_t *buffer = buffer_;
   off_t bytes_written = 0;
-  uint8_t *bounce = NULL;
+  off_t old_length;				// IMTC
+  bool append;					// IMTC
+  uint32_t fresh_start = 0, fresh_end = 0;	// IMTC
 
+  ASSERT (offset >= 0);			// IMTC
+
+  rw_write_acquire (&inode->rw);	// IMTC
   if (inode->deny_write_cnt)
-    return 0;
+    {
+      rw_write_release (&inode->rw);	// IMTC
+      return 0;
+    }
+
+  /* Take small appends into the tail buffer.  Whatever is left
+     over goes through the cache as usual, after the tail. */
+  bytes_written = write_tail (inode, buffer, size, offset);	// IMTC
+  if (bytes_written < size)			// IMTC
+    flush_tail (inode, false);			// IMTC
+  size -= bytes_written;			// IMTC
+  offset += bytes_written;			// IMTC
+
+  old_length = inode->data.length;		// IMTC
+  append = offset + size > old_length;		// IMTC
+
+  /* Write small files inline, moving their data out to a sector
+     once they grow too large. */
+  if (size > 0 && (inode->data.flags & INODE_INLINE))	// IMTC
+    {
+      if (offset + size <= (off_t) INLINE_MAX)	// IMTC
+        {
+          memcpy (inode->data.inline_data + offset, buffer, size);	// IMTC
+          if (offset + size > inode->data.length)	// IMTC
+            inode->data.length = offset + size;	// IMTC
+          cache_write (inode->sector, &inode->data, 0, BLOCK_SECTOR_SIZE);	// IMTC
+          inode_count (inode, FSSTAT_BYTES_WRITTEN, size);	// IMTC
+          rw_write_release (&inode->rw);	// IMTC
+          return size;				// IMTC
+        }
+      if (!move_inline_data (inode))		// IMTC
+        {
+          rw_write_release (&inode->rw);	// IMTC
+          return 0;				// IMTC
+        }
+    }
+
+  /* Sectors allocated past end of file are not zeroed, so zero
+     whatever is allocated between the old end of file and the
+     start of this write. */
+  if (size > 0 && offset > old_length)			// IMTC
+    zero_range (inode, old_length, offset);		// IMTC
 
   while (size > 0) 
     {
       /* Sector to write, starting byte offset within sector. */
-      block_sector_t sector_idx = byte_to_sector (inode, offset);
+      uint32_t file_sector = offset / BLOCK_SECTOR_SIZE;	// IMTC
+      block_sector_t sector_idx = lookup_sector (inode, file_sector);	// IMTC
       int sector_ofs = offset % BLOCK_SECTOR_SIZE;
 
-      /* Bytes left in inode, bytes left in sector, lesser of the two. */
-      off_t inode_left = inode_length (inode) - offset;
-      int sector_left = BLOCK_SECTOR_SIZE - sector_ofs;
-      int min_left = inode_left < sector_left ? inode_left : sector_left;
+      /* Bytes left in sector. */
+      int sector_left = BLOCK_SECTOR_SIZE - sector_ofs;	// IMTC
 
       /* Number of bytes to actually write into this sector. */
-      int chunk_size = size < min_left ? size : min_left;
-      if (chunk_size <= 0)
-        break;
+      int chunk_size = size < sector_left ? size : sector_left;	// IMTC
 
-      if (sector_ofs == 0 && chunk_size == BLOCK_SECTOR_SIZE)
+      /* Allocate sectors for the rest of the write if this one
+         lies in a hole.  Fresh sectors hold garbage, so zero any
+         that the write covers only in part. */
+      if (sector_idx == (block_sector_t) -1)		// IMTC
         {
-          /* Write full sector directly to disk. */
-          block_write (fs_device, sector_idx, buffer + bytes_written);
-        }
-      else 
-        {
-          /* We need a bounce buffer. */
-          if (bounce == NULL) 
-            {
-              bounce = malloc (BLOCK_SECTOR_SIZE);
-              if (bounce == NULL)
-                break;
-            }
-
-          /* If the sector contains data before or after the chunk
-             we're writing, then we need to read in the sector
-             first.  Otherwise we start with a sector of all zeros. */
-          if (sector_ofs > 0 || chunk_size < sector_left) 
-            block_read (fs_device, sector_idx, bounce);
-          else
-            memset (bounce, 0, BLOCK_SECTOR_SIZE);
-          memcpy (bounce + sector_ofs, buffer + bytes_written, chunk_size);
-          block_write (fs_device, sector_idx, bounce);
+          size_t cnt = bytes_to_sectors (offset + size) - file_sector;	// IMTC
+
+          fresh_start = file_sector;			// IMTC
+          fresh_end = file_sector + fill_hole (inode, file_sector, cnt, append);	// IMTC
+          sector_idx = lookup_sector (inode, file_sector);	// IMTC
+          if (sector_idx == (block_sector_t) -1)	// IMTC
+            break;					// IMTC
         }
+      if (file_sector >= fresh_start && file_sector < fresh_end	// IMTC
+          && chunk_size < BLOCK_SECTOR_SIZE)		// IMTC
+        cache_write (sector_idx, zeros, 0, BLOCK_SECTOR_SIZE);	// IMTC
+
+      /* Copy the chunk into the buffer cache.  The cache reads
+         the rest of the sector from disk first if the chunk does
+         not cover all of it. */
+      count_lookup (inode, cache_write (sector_idx, buffer + bytes_written,	// IMTC
+                                        sector_ofs, chunk_size), false);	// IMTC
 
       /* Advance. */
       size -= chunk_size;
       offset += chunk_size;
       bytes_written += chunk_size;
     }
-  free (bounce);
+
+  /* Extend the file over what was written. */
+  if (offset > inode->data.length)			// IMTC
+    inode->data.length = offset;			// IMTC
+  if (fresh_end > 0 || inode->data.length != old_length)	// IMTC
+    cache_write (inode->sector, &inode->data, 0, BLOCK_SECTOR_SIZE);	// IMTC
+  inode_count (inode, FSSTAT_BYTES_WRITTEN, bytes_written);	// IMTC
+  rw_write_release (&inode->rw);	// IMTC
 
   return bytes_written;
 }
 
+// IMTF
+/* Frees the least recently closed inode still in memory.
+   Returns false if there is none.  Must be called with
+   inode_table_lock held. */
+static bool
+evict_closed_inode (void)
+{
+  struct inode *inode;
+
+  if (list_empty (&closed_inodes))
+    return false;
+
+  inode = list_entry (list_pop_back (&closed_inodes), struct inode, lru_elem);
+  hash_delete (&inode_table, &inode->elem);
+  free (inode);
+  return true;
+}
+
+static unsigned
+inode_hash (const struct hash_elem *e, void *aux UNUSED)
+{
+  return hash_int (hash_entry (e, struct inode, elem)->sector);
+}
+
+static bool
+inode_less (const struct hash_elem *a, const struct hash_elem *b,
+            void *aux UNUSED)
+{
+  return (hash_entry (a, struct inode, elem)->sector
+          < hash_entry (b, struct inode, elem)->sector);
+}
+
+// IMTF
+/* Allocates a sector for an index or extent block, filled with
+   zeros, and stores it into *SECTORP.  Returns false if the disk
+   is full. */
+static bool
+allocate_block (block_sector_t *sectorp)
+{
+  if (!free_map_allocate (1, sectorp))
+    return false;
+  cache_write (*sectorp, zeros, 0, BLOCK_SECTOR_SIZE);
+  return true;
+}
+
+// IMTF
+/* Returns entry I of the index sector in *INDEXP, which is the
+   sector of an extent block or of a further index, or 0 if
+   there is none.  If CREATE is true, first allocates the index
+   sector and the sector the entry points to if they are
+   missing, and returns 0 only if the disk is full. */
+static block_sector_t
+index_entry (block_sector_t *indexp, size_t i, bool create)
+{
+  block_sector_t block;
+
+  if (*indexp == 0 && (!create || !allocate_block (indexp)))
+    return 0;
+  cache_read (*indexp, &block, i * sizeof block, sizeof block);
+  if (block == 0 && create && allocate_block (&block))
+    cache_write (*indexp, &block, i * sizeof block, sizeof block);
+  return block;
+}
+
+// IMTF
+/* Returns the sector of the extent block holding DISK's extent
+   number IDX, which must not be a direct extent, or 0 if there
+   is none.  If CREATE is true, allocates the index and extent
+   blocks on the way that are missing, and returns 0 only if the
+   disk is full. */
+static block_sector_t
+extent_block (struct inode_disk *disk, size_t idx, bool create)
+{
+  block_sector_t index;
+
+  ASSERT (idx >= DIRECT_EXTENTS && idx < MAX_EXTENTS);
+
+  idx -= DIRECT_EXTENTS;
+  if (idx < INDEX_EXTENTS)
+    return index_entry (&disk->index, idx / EXTENTS_PER_BLOCK, create);
+
+  idx -= INDEX_EXTENTS;
+  index = index_entry (&disk->index2, idx / INDEX_EXTENTS, create);
+  if (index == 0)
+    return 0;
+  return index_entry (&index, idx % INDEX_EXTENTS / EXTENTS_PER_BLOCK, create);
+}
+
+// IMTF
+/* Returns the position of DISK's extent number IDX, which must
+   not be a direct extent, within its extent block. */
+static inline size_t
+extent_slot (size_t idx)
+{
+  return (idx - DIRECT_EXTENTS) % EXTENTS_PER_BLOCK;
+}
+
+// IMTF
+/* Stores DISK's extent number IDX into *E. */
+static void
+get_extent (struct inode_disk *disk, size_t idx, struct extent *e)
+{
+  ASSERT (idx < disk->extent_cnt);
+
+  if (idx < DIRECT_EXTENTS)
+  {
+    *e = disk->extents[idx];
+    return;
+  }
+
+  cache_read (extent_block (disk, idx, false), e,
+              extent_slot (idx) * sizeof *e, sizeof *e);
+}
+
+// IMTF
+/* Stores E as DISK's extent number IDX, which must be an
+   existing extent or the one just past the last.  Allocates the
+   index and extent blocks it needs; returns false if that
+   fails. */
+static bool
+set_extent (struct inode_disk *disk, size_t idx, const struct extent *e)
+{
+  block_sector_t block;
+
+  ASSERT (idx <= disk->extent_cnt);
+
+  if (idx < DIRECT_EXTENTS)
+  {
+    disk->extents[idx] = *e;
+    return true;
+  }
+  if (idx >= MAX_EXTENTS)
+    return false;
+
+  block = extent_block (disk, idx, true);
+  if (block == 0)
+    return false;
+  cache_write (block, e, extent_slot (idx) * sizeof *e, sizeof *e);
+  return true;
+}
+
+// IMTF
+/* Inserts E as DISK's extent number IDX, moving the extents
+   from IDX on up by one.  The move goes a block at a time, each
+   block's last extent carried over to the start of the next.
+   Returns false, changing nothing, if DISK has no room for
+   another extent or memory runs out. */
+static bool
+insert_extent (struct inode_disk *disk, size_t idx, const struct extent *e)
+{
+  struct extent_block *b;
+  struct extent carry = *e;
+  size_t cnt = disk->extent_cnt;
+
+  ASSERT (idx <= cnt);
+
+  /* Make room for one more extent first, so that failure changes
+     nothing. */
+  if (cnt >= MAX_EXTENTS
+      || (cnt >= DIRECT_EXTENTS && extent_block (disk, cnt, true) == 0))
+    return false;
+  b = malloc (sizeof *b);
+  if (b == NULL)
+    return false;
+  disk->extent_cnt++;
+
+  if (idx < DIRECT_EXTENTS)
+  {
+    struct extent last = disk->extents[DIRECT_EXTENTS - 1];
+
+    memmove (disk->extents + idx + 1, disk->extents + idx,
+             (DIRECT_EXTENTS - 1 - idx) * sizeof *e);
+    disk->extents[idx] = carry;
+    carry = last;
+    idx = DIRECT_EXTENTS;
+  }
+
+  while (idx < disk->extent_cnt)
+  {
+    block_sector_t block = extent_block (disk, idx, false);
+    size_t slot = extent_slot (idx);
+    struct extent last;
+
+    cache_read (block, b, 0, BLOCK_SECTOR_SIZE);
+    last = b->extents[EXTENTS_PER_BLOCK - 1];
+    memmove (b->extents + slot + 1, b->extents + slot,
+             (EXTENTS_PER_BLOCK - 1 - slot) * sizeof *e);
+    b->extents[slot] = carry;
+    cache_write (block, b, 0, BLOCK_SECTOR_SIZE);
+    carry = last;
+    idx += EXTENTS_PER_BLOCK - slot;
+  }
+
+  free (b);
+  return true;
+}
+
+// IMTF
+/* Allocates disk sectors for up to CNT file sectors of INODE
+   starting at SECTOR, which must lie in a hole, and returns how
+   many were allocated, which is 0 if the disk is full.  Stops at
+   the end of the hole.  Places the sectors right after the
+   preceding extent on disk if possible, so that a file written
+   in order stays contiguous.  If the hole is at the end of the
+   file and APPEND is true, also preallocates sectors for the
+   file to grow into. */
+static size_t
+fill_hole (struct inode *inode, uint32_t sector, size_t cnt, bool append)
+{
+  struct inode_disk *disk = &inode->data;
+  struct extent prev = {0, 0, 0};
+  block_sector_t goal = inode->sector + 1;
+  block_sector_t start;
+  size_t lo = 0, hi = disk->extent_cnt;
+  size_t n;
+
+  /* Find the number of extents that start before SECTOR. */
+  while (lo < hi)
+  {
+    size_t mid = (lo + hi) / 2;
+    struct extent e;
+
+    get_extent (disk, mid, &e);
+    if (e.file_sector < sector)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  /* Aim for the disk sector that keeps SECTOR's distance from
+     the preceding extent, which continues that extent if SECTOR
+     directly follows it.  The first extent goes right after the
+     inode. */
+  if (lo > 0)
+  {
+    get_extent (disk, lo - 1, &prev);
+    goal = prev.disk_sector + (sector - prev.file_sector);
+  }
+
+  if (lo < disk->extent_cnt)
+  {
+    struct extent next;
+
+    get_extent (disk, lo, &next);
+    if (cnt > next.file_sector - sector)
+      cnt = next.file_sector - sector;
+  }
+  else if (append)
+  {
+    size_t have = prev.file_sector + prev.sector_cnt;
+
+    cnt += (have < PREALLOC_MIN ? PREALLOC_MIN
+            : have > PREALLOC_MAX ? PREALLOC_MAX : have);
+  }
+
+  n = free_map_allocate_near (goal, cnt, &start);
+  if (n == 0)
+    return 0;
+  fsstat_count (&inode->stat, FSSTAT_ALLOCATIONS, n);
+
+  if (prev.sector_cnt > 0 && prev.file_sector + prev.sector_cnt == sector
+      && prev.disk_sector + prev.sector_cnt == start)
+  {
+    prev.sector_cnt += n;
+    set_extent (disk, lo - 1, &prev);
+  }
+  else
+  {
+    struct extent e = {sector, start, n};
+
+    if (!insert_extent (disk, lo, &e))
+    {
+      free_map_release (start, n);
+      return 0;
+    }
+  }
+  return n;
+}
+
+// IMTF
+/* Releases all of DISK's data sectors, extent blocks and index. */
+static void
+release_sectors (struct inode_disk *disk)
+{
+  size_t i;
+
+  for (i = 0; i < disk->extent_cnt; i++)
+  {
+    struct extent e;
+
+    get_extent (disk, i, &e);
+    free_map_release (e.disk_sector, e.sector_cnt);
+  }
+
+  walk_index (disk->index, 0, release_block);
+  walk_index (disk->index2, 1, release_block);
+}
+
+// IMTF
+/* Calls ACTION on each block listed in index sector INDEX,
+   after going NESTED levels further down through the indexes
+   it lists, and then on INDEX itself.  Does nothing if INDEX
+   is 0. */
+static void
+walk_index (block_sector_t index, int nested,
+            void (*action) (block_sector_t))
+{
+  size_t i;
+
+  if (index == 0)
+    return;
+
+  for (i = 0; i < INDEX_CNT; i++)
+  {
+    block_sector_t block;
+
+    cache_read (index, &block, i * sizeof block, sizeof block);
+    if (nested > 0)
+      walk_index (block, nested - 1, action);
+    else if (block != 0)
+      action (block);
+  }
+  action (index);
+}
+
+// IMTF
+/* Gives back index or extent block SECTOR. */
+static void
+release_block (block_sector_t sector)
+{
+  free_map_release (sector, 1);
+}
+
+// IMTF
+/* Writes index or extent block SECTOR back to disk. */
+static void
+flush_block (block_sector_t sector)
+{
+  cache_flush_range (sector, 1);
+}
+
+// IMTF
+/* Moves INODE's inline data out to a newly allocated sector and
+   switches INODE to extents.  Returns false, leaving INODE as it
+   was, if the disk is full or memory runs out.  Must be called
+   with INODE's lock held for writing. */
+static bool
+move_inline_data (struct inode *inode)
+{
+  struct inode_disk *disk = &inode->data;
+  uint8_t *data;
+  block_sector_t sector;
+
+  ASSERT (disk->flags & INODE_INLINE);
+  ASSERT (disk->extent_cnt == 0);
+
+  data = calloc (1, BLOCK_SECTOR_SIZE);
+  if (data == NULL)
+    return false;
+  memcpy (data, disk->inline_data, INLINE_MAX);
+
+  disk->flags &= ~INODE_INLINE;
+  memset (disk->extents, 0, sizeof disk->extents);
+  if (disk->length > 0)
+  {
+    if (fill_hole (inode, 0, 1, true) == 0)
+    {
+      memcpy (disk->inline_data, data, INLINE_MAX);
+      disk->flags |= INODE_INLINE;
+      free (data);
+      return false;
+    }
+    sector = lookup_sector (inode, 0);
+    cache_write (sector, data, 0, BLOCK_SECTOR_SIZE);
+  }
+  cache_write (inode->sector, disk, 0, BLOCK_SECTOR_SIZE);
+
+  free (data);
+  return true;
+}
+
+// IMTF
+/* Gives back the sectors INODE has allocated past the end of its
+   data.  Must be called with inode_table_lock held, after the
+   last opener has closed INODE. */
+static void
+trim_sectors (struct inode *inode)
+{
+  struct inode_disk *disk = &inode->data;
+  size_t keep = bytes_to_sectors (disk->length);
+  bool changed = false;
+
+  while (disk->extent_cnt > 0)
+  {
+    struct extent last;
+    size_t end;
+
+    get_extent (disk, disk->extent_cnt - 1, &last);
+    end = last.file_sector + last.sector_cnt;
+    if (end <= keep)
+      break;
+
+    if (last.file_sector >= keep)
+    {
+      free_map_release (last.disk_sector, last.sector_cnt);
+      disk->extent_cnt--;
+    }
+    else
+    {
+      free_map_release (last.disk_sector + (keep - last.file_sector),
+                        end - keep);
+      last.sector_cnt -= end - keep;
+      set_extent (disk, disk->extent_cnt - 1, &last);
+    }
+    changed = true;
+  }
+
+  if (changed)
+  {
+    inode->hint.sector_cnt = 0;
+    cache_write (inode->sector, disk, 0, BLOCK_SECTOR_SIZE);
+  }
+}
+
+// IMTF
+/* Writes zeros over whatever disk sectors INODE has allocated
+   for bytes START...END-1, leaving holes alone.  Must be called
+   with INODE's lock held for writing. */
+static void
+zero_range (struct inode *inode, off_t start, off_t end)
+{
+  struct extent last;
+  off_t allocated;
+
+  /* Nothing is allocated past the last extent. */
+  if (inode->data.extent_cnt == 0)
+    return;
+  get_extent (&inode->data, inode->data.extent_cnt - 1, &last);
+  allocated = (off_t) (last.file_sector + last.sector_cnt) * BLOCK_SECTOR_SIZE;
+  if (end > allocated)
+    end = allocated;
+
+  while (start < end)
+  {
+    block_sector_t sector = lookup_sector (inode, start / BLOCK_SECTOR_SIZE);
+    int sector_ofs = start % BLOCK_SECTOR_SIZE;
+    off_t chunk = BLOCK_SECTOR_SIZE - sector_ofs;
+
+    if (chunk > end - start)
+      chunk = end - start;
+    if (sector != (block_sector_t) -1)
+      cache_write (sector, zeros, sector_ofs, chunk);
+    start += chunk;
+  }
+}
+
+// IMTF
+/* Copies as much as possible of the SIZE bytes at BUFFER,
+   appended at OFFSET, into INODE's tail buffer: a copy of the
+   sector holding its end of file that is kept in memory, so
+   that a run of small appends reaches the buffer cache once,
+   when the sector fills up, instead of once per append.  Only
+   appends shorter than a sector to a file stored in extents are
+   taken.  Returns the number of bytes taken, which is 0 if the
+   write does not qualify or memory or disk space runs out.  Must
+   be called with INODE's lock held for writing. */
+static off_t
+write_tail (struct inode *inode, const uint8_t *buffer, off_t size,
+            off_t offset)
+{
+  off_t taken = 0;
+
+  if (size <= 0 || size >= BLOCK_SECTOR_SIZE
+      || offset != inode->data.length
+      || (inode->data.flags & (INODE_INLINE | INODE_DIR)))
+    return 0;
+
+  while (taken < size)
+  {
+    int sector_ofs = offset % BLOCK_SECTOR_SIZE;
+    int chunk = BLOCK_SECTOR_SIZE - sector_ofs;
+
+    if (chunk > size - taken)
+      chunk = size - taken;
+    if (inode->tail == NULL && !start_tail (inode, offset))
+      break;
+
+    memcpy (inode->tail + sector_ofs, buffer + taken, chunk);
+    taken += chunk;
+    offset += chunk;
+    inode->data.length = offset;
+    if (sector_ofs + chunk == BLOCK_SECTOR_SIZE)
+      flush_tail (inode, false);
+  }
+  return taken;
+}
+
+// IMTF
+/* Gives INODE a tail buffer for the sector that holds byte
+   OFFSET, allocating the sector if it lies in a hole.  Returns
+   false if memory or disk space runs out.  Must be called with
+   INODE's lock held for writing. */
+static bool
+start_tail (struct inode *inode, off_t offset)
+{
+  uint32_t file_sector = offset / BLOCK_SECTOR_SIZE;
+  block_sector_t sector = lookup_sector (inode, file_sector);
+  bool fresh = false;
+  uint8_t *tail;
+
+  ASSERT (inode->tail == NULL);
+
+  tail = malloc (BLOCK_SECTOR_SIZE);
+  if (tail == NULL)
+    return false;
+  if (sector == (block_sector_t) -1)
+  {
+    if (fill_hole (inode, file_sector, 1, true) == 0)
+    {
+      free (tail);
+      return false;
+    }
+    sector = lookup_sector (inode, file_sector);
+    fresh = true;
+  }
+
+  /* The sector is written back whole, so everything past end of
+     file in it must be zeros. */
+  if (fresh || offset % BLOCK_SECTOR_SIZE == 0)
+    memset (tail, 0, BLOCK_SECTOR_SIZE);
+  else
+    count_lookup (inode, cache_read (sector, tail, 0, BLOCK_SECTOR_SIZE),
+                  true);
+
+  inode->tail = tail;
+  inode->tail_sector = file_sector;
+  inode->tail_disk = sector;
+  inode->tail_time = timer_ticks ();
+  return true;
+}
+
+// IMTF
+/* Writes INODE's tail buffer, if it has one, into the buffer
+   cache, followed by the inode, whose length covers the tail,
+   and frees the buffer.  If SYNC is true, also writes both
+   sectors on to disk.  Must be called with INODE's lock held for
+   writing. */
+static void
+flush_tail (struct inode *inode, bool sync)
+{
+  if (inode->tail == NULL)
+    return;
+
+  count_lookup (inode, cache_write (inode->tail_disk, inode->tail, 0,
+                                    BLOCK_SECTOR_SIZE), false);
+  cache_write (inode->sector, &inode->data, 0, BLOCK_SECTOR_SIZE);
+  if (sync)
+  {
+    cache_flush_range (inode->tail_disk, 1);
+    cache_flush_range (inode->sector, 1);
+  }
+
+  free (inode->tail);
+  inode->tail = NULL;
+}
+
 /* Disables writes to INODE.
    May be called at most once per inode opener. */
 void
 inode_deny_write (struct inode *inode) 
 {
+  rw_write_acquire (&inode->rw);	// IMTC
   inode->deny_write_cnt++;
   ASSERT (inode->deny_write_cnt <= inode->open_cnt);
+  rw_write_release (&inode->rw);	// IMTC
 }
 
 /* Re-enables writes to INODE.
@@ -332,9 +1581,11 @@ inode_deny_write (struct inode *inode)
 void
 inode_allow_write (struct inode *inode) 
 {
+  rw_write_acquire (&inode->rw);	// IMTC
   ASSERT (inode->deny_write_cnt > 0);
   ASSERT (inode->deny_write_cnt <= inode->open_cnt);
   inode->deny_write_cnt--;
+  rw_write_release (&inode->rw);	// IMTC
 }
 
 /* Returns the length, in bytes, of INODE's data. */
@@ -4,18 +4,34 @@
 #include <stdbool.h>
 #include "filesys/off_t.h"
 #include "devices/block.h"
+#include <fsstat.h>	// IMTC
 
 struct bitmap;
 
 void inode_init (void);
-bool inode_create (block_sector_t, off_t);
+bool inode_create (block_sector_t, off_t, bool is_dir);
 struct inode *inode_open (block_sector_t);
 struct inode *inode_reopen (struct inode *);
 block_sector_t inode_get_inumber (const struct inode *);
+bool inode_is_dir (const struct inode *);
 void inode_close (struct inode *);
 void inode_remove (struct inode *);
+void inode_lock_dir (struct inode *);
+void inode_unlock_dir (struct inode *);
+void inode_begin_listing (struct inode *);
+void inode_end_listing (struct inode *);
+bool inode_is_listed (struct inode *);
 off_t inode_read_at (struct inode *, void *, off_t size, off_t offset);
 off_t inode_write_at (struct inode *, const void *, off_t size, off_t offset);
+off_t inode_read_ahead (struct inode *, off_t offset, off_t length);
+off_t inode_read_direct (struct inode *, void *, off_t size, off_t offset);
+off_t inode_write_direct (struct inode *, const void *, off_t size, off_t offset);
+void inode_flush (struct inode *);
+void inode_flush_tails (int64_t deadline);
+void inode_count (struct inode *, enum fsstat_counter, unsigned long long n);
+void inode_get_stat (struct inode *, struct fsstat *);
+void inode_print_stats (void);
+bool inode_reserve (struct inode *, off_t length);
 void inode_deny_write (struct inode *);
 void inode_allow_write (struct inode *);
 off_t inode_length (const struct inode *);
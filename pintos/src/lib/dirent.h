@@ -0,0 +1,23 @@
+#ifndef __LIB_DIRENT_H
+#define __LIB_DIRENT_H
+
+/* Directory entry records, shared between the kernel (which
+   fills them) and user programs (which read them with the
+   getdents() system call). */
+
+/* Maximum length of a file name in a record. */
+#define DIRENT_NAME_MAX 14
+
+/* File types. */
+#define DIRENT_FILE 1           /* Ordinary file. */
+#define DIRENT_DIR 2            /* Directory. */
+
+/* One directory entry. */
+struct dirent
+  {
+    unsigned inumber;                   /* Inode number. */
+    int type;                           /* DIRENT_FILE or DIRENT_DIR. */
+    char name[DIRENT_NAME_MAX + 1];     /* Null terminated file name. */
+  };
+
+#endif /* lib/dirent.h */
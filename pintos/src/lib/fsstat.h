@@ -0,0 +1,44 @@
+#ifndef __LIB_FSSTAT_H
+#define __LIB_FSSTAT_H
+
+/* File system statistics, shared between the kernel (which
+   collects them) and user programs (which read them with the
+   fsstat() system call).  The kernel keeps one set for each
+   in-memory inode and one for the whole file system. */
+
+/* Kinds of file system events that are counted.
+
+   Cache hits and misses count sectors looked up by reads and
+   writes, not by read-ahead.  Globally, SECTORS_READ and
+   SECTORS_WRITTEN count every transfer to or from the file
+   system device; for an inode, they count the sectors its cache
+   misses and direct I/O moved, since write-back from the cache
+   is not traced to a file.  For a directory, DIR_LOOKUPS counts
+   the names looked up in it.  ALLOCATIONS counts sectors taken
+   from the free map, and FREE_MAP_WRITES the sectors of the free
+   map written out; the latter is only kept globally. */
+enum fsstat_counter
+  {
+    FSSTAT_BYTES_READ,          /* Bytes read from files. */
+    FSSTAT_BYTES_WRITTEN,       /* Bytes written to files. */
+    FSSTAT_SECTORS_READ,        /* Sectors read from disk. */
+    FSSTAT_SECTORS_WRITTEN,     /* Sectors written to disk. */
+    FSSTAT_CACHE_HITS,          /* Sectors found in the buffer cache. */
+    FSSTAT_CACHE_MISSES,        /* Sectors not found in the cache. */
+    FSSTAT_DIR_LOOKUPS,         /* Names looked up in directories. */
+    FSSTAT_ALLOCATIONS,         /* Sectors allocated. */
+    FSSTAT_FREE_MAP_WRITES,     /* Free map sectors written. */
+    FSSTAT_COUNTER_CNT
+  };
+
+/* Pass as the file descriptor to fsstat() to read the totals for
+   the whole file system. */
+#define FSSTAT_GLOBAL (-1)
+
+/* A set of file system statistics. */
+struct fsstat
+  {
+    unsigned long long counters[FSSTAT_COUNTER_CNT];
+  };
+
+#endif /* lib/fsstat.h */
@@ -0,0 +1,18 @@
+#ifndef __LIB_IOVEC_H
+#define __LIB_IOVEC_H
+
+#include <stddef.h>
+
+/* One buffer of a vectored read or write, shared between the
+   kernel and user programs (the readv() and writev() system
+   calls). */
+struct iovec
+  {
+    void *iov_base;             /* Start of buffer. */
+    size_t iov_len;             /* Buffer length in bytes. */
+  };
+
+/* Most buffers accepted by a single readv() or writev(). */
+#define IOV_MAX 64
+
+#endif /* lib/iovec.h */
@@ -28,7 +28,50 @@ enum
     SYS_MKDIR,                  /* Create a directory. */
     SYS_READDIR,                /* Reads a directory entry. */
     SYS_ISDIR,                  /* Tests if a fd represents a directory. */
-    SYS_INUMBER                 /* Returns the inode number for a fd. */
+    SYS_INUMBER,                /* Returns the inode number for a fd. */
+
+    /* Statistics. */
+    SYS_VMSTAT,                 /* Reads virtual memory statistics. */
+
+    /* Paging control. */
+    SYS_EXEC_MODE,              /* Start another process, choosing how
+                                   its executable is paged in. */
+
+    /* Positioned and vectored I/O. */
+    SYS_PREAD,                  /* Read from a file at an offset. */
+    SYS_PWRITE,                 /* Write to a file at an offset. */
+    SYS_READV,                  /* Read from a file into many buffers. */
+    SYS_WRITEV,                 /* Write to a file from many buffers. */
+
+    /* File copying. */
+    SYS_COPY_FILE_RANGE,        /* Copy data between files in the kernel. */
+
+    /* Directory listing. */
+    SYS_GETDENTS,               /* Reads many directory entries at once. */
+
+    /* Write-back. */
+    SYS_FSYNC,                  /* Writes a file's data to disk. */
+
+    /* Direct I/O. */
+    SYS_OPEN_MODE,              /* Opens a file, choosing how its data
+                                   is transferred. */
+
+    /* File system statistics. */
+    SYS_FSSTAT,                 /* Reads file system statistics. */
+
+    /* Timing. */
+    SYS_TICKS                   /* Returns timer ticks since boot. */
   };
 
+/* Paging modes for SYS_EXEC_MODE. */
+#define EXEC_DEFAULT 0          /* Follow the kernel's -prefault option. */
+#define EXEC_LAZY 1             /* Load every page on first access. */
+#define EXEC_PREFAULT 2         /* Load small executables, and the first
+                                   pages of the entry segment, eagerly. */
+
+/* Flags for SYS_OPEN_MODE. */
+#define OPEN_DIRECT 0x1         /* Move sector-aligned transfers straight
+                                   between disk and user memory, bypassing
+                                   the buffer cache. */
+
 #endif /* lib/syscall-nr.h */
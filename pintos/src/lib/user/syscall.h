@@ -3,6 +3,11 @@
 
 #include <stdbool.h>
 #include <debug.h>
+#include <dirent.h>
+#include <fsstat.h>
+#include <iovec.h>
+#include <syscall-nr.h>
+#include <vmstat.h>
 
 /* Process identifier. */
 typedef int pid_t;
@@ -45,4 +50,35 @@ bool readdir (int fd, char name[READDIR_MAX_LEN + 1]);
 bool isdir (int fd);
 int inumber (int fd);
 
+/* Statistics. */
+bool vmstat (struct vmstat *, bool global);
+
+/* Paging control. */
+pid_t exec_mode (const char *file, int mode);
+
+/* Positioned and vectored I/O. */
+int pread (int fd, void *buffer, unsigned length, unsigned offset);
+int pwrite (int fd, const void *buffer, unsigned length, unsigned offset);
+int readv (int fd, const struct iovec *, int iovcnt);
+int writev (int fd, const struct iovec *, int iovcnt);
+
+/* File copying. */
+int copy_file_range (int in_fd, int in_offset, int out_fd, int out_offset,
+                     unsigned length);
+
+/* Directory listing. */
+int getdents (int fd, struct dirent *, int cnt, unsigned *cookie);
+
+/* Write-back. */
+int fsync (int fd);
+
+/* Direct I/O. */
+int open_mode (const char *file, int mode);
+
+/* File system statistics. */
+bool fsstat (int fd, struct fsstat *);
+
+/* Timing. */
+unsigned ticks (void);
+
 #endif /* lib/user/syscall.h */
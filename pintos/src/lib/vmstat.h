@@ -0,0 +1,49 @@
+#ifndef __LIB_VMSTAT_H
+#define __LIB_VMSTAT_H
+
+/* Virtual memory statistics, shared between the kernel (which
+   collects them) and user programs (which read them with the
+   vmstat() system call). */
+
+/* Kinds of VM events that are counted and timed. */
+enum vmstat_event
+  {
+    VMSTAT_MINOR,               /* Fault satisfied without I/O. */
+    VMSTAT_FILE_LOAD,           /* Page read from its backing file. */
+    VMSTAT_SWAP_IN,             /* Page read back from swap. */
+    VMSTAT_STACK_GROWTH,        /* New stack page allocated. */
+    VMSTAT_EVICT,               /* Frame evicted to make room. */
+    VMSTAT_WRITEBACK,           /* Dirty page written to swap or file. */
+    VMSTAT_PREFAULT,            /* Page loaded eagerly by exec. */
+    VMSTAT_EVENT_CNT
+  };
+
+/* Number of latency histogram buckets per event.
+   Bucket 0 counts events that took fewer than
+   VMSTAT_HIST_BASE cycles, bucket I counts events that took
+   fewer than VMSTAT_HIST_BASE << (2 * I) cycles, and the last
+   bucket counts everything slower than that. */
+#define VMSTAT_HIST_CNT 8
+#define VMSTAT_HIST_BASE 4096
+
+/* Counter and latency totals for one kind of event. */
+struct vmstat_counter
+  {
+    unsigned long long cnt;             /* Number of events. */
+    unsigned long long ticks;           /* Total timer ticks spent. */
+    unsigned long long cycles;          /* Total TSC cycles spent. */
+    unsigned long long max_cycles;      /* Slowest single event. */
+    unsigned long long hist[VMSTAT_HIST_CNT];   /* Cycle histogram. */
+  };
+
+/* A full set of VM statistics, either for one process or for
+   the whole system. */
+struct vmstat
+  {
+    struct vmstat_counter events[VMSTAT_EVENT_CNT];
+    unsigned swap_slots;                /* Swap slots now in use. */
+    unsigned swap_slots_peak;           /* Most swap slots ever in use. */
+    unsigned swap_slots_total;          /* Swap slots available (global). */
+  };
+
+#endif /* lib/vmstat.h */
@@ -0,0 +1,65 @@
+/* Copies a file with copy_file_range(), once through the file
+   positions and once at explicit offsets, and verifies the
+   copies.  Then copies within one file, which must be refused
+   when the two ranges overlap. */
+
+#include <random.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char buf[6000];
+static char expect[6000];
+
+void
+test_main (void) 
+{
+  int in_fd, out_fd, dup_fd;
+
+  random_bytes (buf, sizeof buf);
+  CHECK (create ("source", 0), "create \"source\"");
+  CHECK ((in_fd = open ("source")) > 1, "open \"source\"");
+  CHECK (write (in_fd, buf, sizeof buf) == sizeof buf, "write \"source\"");
+  msg ("seek \"source\" to 0");
+  seek (in_fd, 0);
+
+  CHECK (create ("copy", 0), "create \"copy\"");
+  CHECK ((out_fd = open ("copy")) > 1, "open \"copy\"");
+  CHECK (copy_file_range (in_fd, -1, out_fd, -1, 1000) == 1000,
+         "copy 1000 bytes at file positions");
+  CHECK (copy_file_range (in_fd, -1, out_fd, -1, sizeof buf) == 5000,
+         "copy the rest at file positions");
+  CHECK (tell (in_fd) == sizeof buf && tell (out_fd) == sizeof buf,
+         "file positions advanced");
+  check_file ("copy", buf, sizeof buf);
+
+  CHECK (copy_file_range (in_fd, 100, out_fd, 3100, 200) == 200,
+         "copy 200 bytes at offsets");
+  CHECK (tell (in_fd) == sizeof buf && tell (out_fd) == sizeof buf,
+         "file positions unchanged");
+  memcpy (expect, buf, sizeof buf);
+  memcpy (expect + 3100, buf + 100, 200);
+  check_file ("copy", expect, sizeof expect);
+
+  CHECK (copy_file_range (out_fd, 0, out_fd, 100, 200) == -1,
+         "copy overlapping range of one descriptor");
+  CHECK ((dup_fd = open ("copy")) > 1, "open \"copy\" again");
+  CHECK (copy_file_range (out_fd, 100, dup_fd, 0, 200) == -1,
+         "copy overlapping range of two descriptors");
+  CHECK (copy_file_range (out_fd, 0, dup_fd, 1000, 200) == 200,
+         "copy disjoint range within \"copy\"");
+  memcpy (expect + 1000, expect, 200);
+  check_file ("copy", expect, sizeof expect);
+  msg ("close \"copy\"");
+  close (dup_fd);
+
+  CHECK (copy_file_range (in_fd, sizeof buf, out_fd, 0, 10) == 0,
+         "copy from end of file");
+  CHECK (copy_file_range (in_fd, 0, 100, 0, 10) == -1,
+         "copy to bad fd");
+  msg ("close \"source\"");
+  close (in_fd);
+  msg ("close \"copy\"");
+  close (out_fd);
+}
@@ -0,0 +1,38 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(copy-range) begin
+(copy-range) create "source"
+(copy-range) open "source"
+(copy-range) write "source"
+(copy-range) seek "source" to 0
+(copy-range) create "copy"
+(copy-range) open "copy"
+(copy-range) copy 1000 bytes at file positions
+(copy-range) copy the rest at file positions
+(copy-range) file positions advanced
+(copy-range) open "copy" for verification
+(copy-range) verified contents of "copy"
+(copy-range) close "copy"
+(copy-range) copy 200 bytes at offsets
+(copy-range) file positions unchanged
+(copy-range) open "copy" for verification
+(copy-range) verified contents of "copy"
+(copy-range) close "copy"
+(copy-range) copy overlapping range of one descriptor
+(copy-range) open "copy" again
+(copy-range) copy overlapping range of two descriptors
+(copy-range) copy disjoint range within "copy"
+(copy-range) open "copy" for verification
+(copy-range) verified contents of "copy"
+(copy-range) close "copy"
+(copy-range) close "copy"
+(copy-range) copy from end of file
+(copy-range) copy to bad fd
+(copy-range) close "source"
+(copy-range) close "copy"
+(copy-range) end
+EOF
+pass;
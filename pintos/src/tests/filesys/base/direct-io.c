@@ -0,0 +1,83 @@
+/* Writes and reads a file through a descriptor opened with
+   OPEN_DIRECT, mixing sector-aligned transfers, which bypass the
+   buffer cache, with unaligned ones and with cached access
+   through a second descriptor, and checks that every view of the
+   file agrees.  Also reads a file small enough to be kept inline
+   in its inode directly. */
+
+#include <random.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define SIZE 8192
+#define SMALL_SIZE 300
+
+static char buf[SIZE] __attribute__ ((aligned (512)));
+static char buf2[SIZE] __attribute__ ((aligned (512)));
+
+void
+test_main (void) 
+{
+  int direct_fd, cached_fd, small_fd;
+  int i;
+
+  random_bytes (buf, sizeof buf);
+  CHECK (create ("data", 0), "create \"data\"");
+  CHECK (open_mode ("data", 0x100) == -1, "open with bad mode");
+  CHECK ((direct_fd = open_mode ("data", OPEN_DIRECT)) > 1,
+         "open \"data\" for direct I/O");
+  CHECK ((cached_fd = open ("data")) > 1, "open \"data\" again");
+
+  CHECK (write (direct_fd, buf, 4096) == 4096, "aligned direct write");
+  CHECK (write (direct_fd, buf + 4096, 100) == 100, "unaligned write");
+  CHECK (pwrite (direct_fd, buf + 4196, SIZE - 4196, 4196) == SIZE - 4196,
+         "unaligned pwrite");
+  check_file ("data", buf, sizeof buf);
+
+  /* A sector dirty in the cache must be seen by direct reads. */
+  buf[1000] ^= 0xff;
+  CHECK (pwrite (cached_fd, buf + 1000, 1, 1000) == 1,
+         "cached write into first sector");
+  CHECK (pread (direct_fd, buf2, SIZE, 0) == SIZE, "aligned direct pread");
+  compare_bytes (buf2, buf, SIZE, 0, "data");
+
+  /* And a direct write must replace the cached copy. */
+  random_bytes (buf, 2048);
+  CHECK (pwrite (direct_fd, buf, 2048, 0) == 2048, "aligned direct pwrite");
+  CHECK (pread (cached_fd, buf2, 2048, 0) == 2048, "cached pread");
+  compare_bytes (buf2, buf, 2048, 0, "data");
+
+  /* Direct reads stop at end of file. */
+  memset (buf2, 0xcc, 1024);
+  CHECK (pread (direct_fd, buf2, 1024, SIZE - 512) == 512,
+         "direct pread across end of file");
+  compare_bytes (buf2, buf + SIZE - 512, 512, SIZE - 512, "data");
+
+  msg ("close \"data\"");
+  close (direct_fd);
+  msg ("close \"data\"");
+  close (cached_fd);
+  check_file ("data", buf, sizeof buf);
+
+  /* A direct read of an inline file pads its sector with zeros,
+     just like one of a file kept in sectors. */
+  CHECK (create ("small", 0), "create \"small\"");
+  CHECK ((small_fd = open ("small")) > 1, "open \"small\"");
+  CHECK (write (small_fd, buf, SMALL_SIZE) == SMALL_SIZE,
+         "write %d bytes to \"small\"", SMALL_SIZE);
+  msg ("close \"small\"");
+  close (small_fd);
+  CHECK ((small_fd = open_mode ("small", OPEN_DIRECT)) > 1,
+         "open \"small\" for direct I/O");
+  memset (buf2, 0xcc, 1024);
+  CHECK (pread (small_fd, buf2, 1024, 0) == SMALL_SIZE,
+         "direct pread of \"small\"");
+  compare_bytes (buf2, buf, SMALL_SIZE, 0, "small");
+  for (i = SMALL_SIZE; i < 512; i++)
+    if (buf2[i] != 0)
+      fail ("byte %d past end of \"small\" is %d, not 0", i, buf2[i]);
+  msg ("close \"small\"");
+  close (small_fd);
+}
@@ -0,0 +1,36 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(direct-io) begin
+(direct-io) create "data"
+(direct-io) open with bad mode
+(direct-io) open "data" for direct I/O
+(direct-io) open "data" again
+(direct-io) aligned direct write
+(direct-io) unaligned write
+(direct-io) unaligned pwrite
+(direct-io) open "data" for verification
+(direct-io) verified contents of "data"
+(direct-io) close "data"
+(direct-io) cached write into first sector
+(direct-io) aligned direct pread
+(direct-io) aligned direct pwrite
+(direct-io) cached pread
+(direct-io) direct pread across end of file
+(direct-io) close "data"
+(direct-io) close "data"
+(direct-io) open "data" for verification
+(direct-io) verified contents of "data"
+(direct-io) close "data"
+(direct-io) create "small"
+(direct-io) open "small"
+(direct-io) write 300 bytes to "small"
+(direct-io) close "small"
+(direct-io) open "small" for direct I/O
+(direct-io) direct pread of "small"
+(direct-io) close "small"
+(direct-io) end
+EOF
+pass;
@@ -0,0 +1,61 @@
+/* Writes one byte into every other sector of a sparse file, so
+   that each byte's sector becomes an extent of its own, until the
+   file has more extents than the inode's first-level index can
+   hold.  Then reads every byte back, along with the holes between
+   them. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define SECTOR_SIZE 512
+#define BYTE_CNT 6000
+
+/* Returns the byte written at sector 2 * I. */
+static char
+byte_at (int i) 
+{
+  return i % 251 + 1;
+}
+
+void
+test_main (void) 
+{
+  const char *file_name = "frag";
+  int length = 2 * BYTE_CNT * SECTOR_SIZE;
+  char c;
+  int fd;
+  int i;
+
+  CHECK (create (file_name, 0), "create \"%s\"", file_name);
+  CHECK ((fd = open (file_name)) > 1, "open \"%s\"", file_name);
+
+  /* Set the length first, so that the writes below fill holes
+     and do not preallocate. */
+  c = 0;
+  CHECK (pwrite (fd, &c, 1, length - 1) == 1, "extend \"%s\"", file_name);
+
+  msg ("write %d separate sectors", BYTE_CNT);
+  for (i = 0; i < BYTE_CNT; i++)
+    {
+      c = byte_at (i);
+      if (pwrite (fd, &c, 1, 2 * i * SECTOR_SIZE) != 1)
+        fail ("write to sector %d failed", 2 * i);
+    }
+  CHECK (filesize (fd) == length, "file size is %d", length);
+
+  msg ("read back %d sectors", 2 * BYTE_CNT);
+  for (i = 0; i < 2 * BYTE_CNT; i++)
+    {
+      char expected = i % 2 == 0 ? byte_at (i / 2) : 0;
+
+      if (pread (fd, &c, 1, i * SECTOR_SIZE) != 1)
+        fail ("read of sector %d failed", i);
+      if (c != expected)
+        fail ("sector %d starts with %d, not %d", i, c, expected);
+    }
+
+  msg ("close \"%s\"", file_name);
+  close (fd);
+  CHECK (remove (file_name), "remove \"%s\"", file_name);
+}
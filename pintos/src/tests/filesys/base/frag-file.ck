@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(frag-file) begin
+(frag-file) create "frag"
+(frag-file) open "frag"
+(frag-file) extend "frag"
+(frag-file) write 6000 separate sectors
+(frag-file) file size is 6144000
+(frag-file) read back 12000 sectors
+(frag-file) close "frag"
+(frag-file) remove "frag"
+(frag-file) end
+EOF
+pass;
@@ -0,0 +1,49 @@
+/* Writes and reads back a file and verifies that fsstat()
+   charges the bytes to the file and to the global totals, and
+   that it rejects bad file descriptors. */
+
+#include <fsstat.h>
+#include <random.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char buf[2000];
+
+void
+test_main (void) 
+{
+  struct fsstat before, after, file;
+  int fd;
+
+  random_bytes (buf, sizeof buf);
+  CHECK (fsstat (FSSTAT_GLOBAL, &before), "fsstat global");
+  CHECK (create ("data", 0), "create \"data\"");
+  CHECK ((fd = open ("data")) > 1, "open \"data\"");
+  CHECK (write (fd, buf, sizeof buf) == sizeof buf, "write \"data\"");
+  seek (fd, 0);
+  CHECK (read (fd, buf, sizeof buf) == sizeof buf, "read \"data\"");
+
+  CHECK (fsstat (fd, &file), "fsstat \"data\"");
+  if (file.counters[FSSTAT_BYTES_WRITTEN] != sizeof buf)
+    fail ("\"data\" has %llu bytes written, expected %zu",
+          file.counters[FSSTAT_BYTES_WRITTEN], sizeof buf);
+  if (file.counters[FSSTAT_BYTES_READ] != sizeof buf)
+    fail ("\"data\" has %llu bytes read, expected %zu",
+          file.counters[FSSTAT_BYTES_READ], sizeof buf);
+
+  CHECK (fsstat (FSSTAT_GLOBAL, &after), "fsstat global again");
+  if (after.counters[FSSTAT_BYTES_WRITTEN]
+      < before.counters[FSSTAT_BYTES_WRITTEN] + sizeof buf)
+    fail ("global bytes written did not grow");
+  if (after.counters[FSSTAT_BYTES_READ]
+      < before.counters[FSSTAT_BYTES_READ] + sizeof buf)
+    fail ("global bytes read did not grow");
+  if (after.counters[FSSTAT_DIR_LOOKUPS]
+      <= before.counters[FSSTAT_DIR_LOOKUPS])
+    fail ("global directory lookups did not grow");
+
+  CHECK (!fsstat (fd + 100, &file), "fsstat bad fd");
+  msg ("close \"data\"");
+  close (fd);
+}
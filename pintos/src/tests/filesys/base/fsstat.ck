@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(fsstat) begin
+(fsstat) fsstat global
+(fsstat) create "data"
+(fsstat) open "data"
+(fsstat) write "data"
+(fsstat) read "data"
+(fsstat) fsstat "data"
+(fsstat) fsstat global again
+(fsstat) fsstat bad fd
+(fsstat) close "data"
+(fsstat) end
+EOF
+pass;
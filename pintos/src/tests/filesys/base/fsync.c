@@ -0,0 +1,30 @@
+/* Writes a file in pieces, calling fsync() after some of them,
+   and verifies that fsync() succeeds on open files, fails on bad
+   file descriptors, and leaves the data intact. */
+
+#include <random.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char buf[9000];
+
+void
+test_main (void) 
+{
+  int fd;
+
+  random_bytes (buf, sizeof buf);
+  CHECK (create ("data", 0), "create \"data\"");
+  CHECK ((fd = open ("data")) > 1, "open \"data\"");
+  CHECK (write (fd, buf, 100) == 100, "write 100 bytes");
+  CHECK (fsync (fd) == 0, "fsync \"data\"");
+  CHECK (write (fd, buf + 100, sizeof buf - 100) == sizeof buf - 100,
+         "write the rest");
+  CHECK (fsync (fd) == 0, "fsync \"data\" again");
+  CHECK (fsync (fd) == 0, "fsync clean \"data\"");
+  CHECK (fsync (fd + 100) == -1, "fsync bad fd");
+  msg ("close \"data\"");
+  close (fd);
+  check_file ("data", buf, sizeof buf);
+}
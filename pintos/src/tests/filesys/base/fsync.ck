@@ -0,0 +1,21 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(fsync) begin
+(fsync) create "data"
+(fsync) open "data"
+(fsync) write 100 bytes
+(fsync) fsync "data"
+(fsync) write the rest
+(fsync) fsync "data" again
+(fsync) fsync clean "data"
+(fsync) fsync bad fd
+(fsync) close "data"
+(fsync) open "data" for verification
+(fsync) verified contents of "data"
+(fsync) close "data"
+(fsync) end
+EOF
+pass;
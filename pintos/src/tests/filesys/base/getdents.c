@@ -0,0 +1,154 @@
+/* Creates enough files to split the root directory's buckets,
+   then lists the directory with getdents() in small batches and
+   checks that every file comes back exactly once, with the
+   right type and inode number.  As many files again are created
+   after the first batch; they may or may not be listed, but
+   must not make any file come back twice.  readdir() must then
+   list every file exactly once, and still does after more files
+   are created once the listing is over. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define FILE_CNT 60
+#define BATCH 7
+
+static int seen[FILE_CNT];
+static int inumbers[FILE_CNT];
+static int added_seen[FILE_CNT];
+static int later_seen[FILE_CNT];
+
+/* Creates FILE_CNT empty files named PREFIX followed by a
+   number, storing their inode numbers in INUMS if it is
+   non-null. */
+static void
+create_files (char prefix, int *inums) 
+{
+  char name[READDIR_MAX_LEN + 1];
+  int i;
+
+  for (i = 0; i < FILE_CNT; i++)
+    {
+      int fd;
+
+      snprintf (name, sizeof name, "%c%d", prefix, i);
+      if (!create (name, 0))
+        fail ("create \"%s\"", name);
+      if ((fd = open (name)) < 2)
+        fail ("open \"%s\"", name);
+      if (isdir (fd))
+        fail ("\"%s\" is a directory", name);
+      if (inums != NULL)
+        inums[i] = inumber (fd);
+      close (fd);
+    }
+}
+
+/* Returns the index of entry NAME if it starts with PREFIX,
+   otherwise -1. */
+static int
+entry_index (const char *name, char prefix) 
+{
+  int idx;
+
+  if (name[0] != prefix)
+    return -1;
+  idx = atoi (name + 1);
+  if (idx < 0 || idx >= FILE_CNT)
+    fail ("unexpected entry \"%s\"", name);
+  return idx;
+}
+
+/* Lists the rest of DIR_FD with readdir() and checks that it
+   holds each file named with one of the first PREFIX_CNT
+   prefixes exactly once. */
+static void
+check_readdir (int dir_fd, int prefix_cnt) 
+{
+  static const char prefixes[] = "fgh";
+  int *counts[] = {seen, added_seen, later_seen};
+  char name[READDIR_MAX_LEN + 1];
+  int i, p;
+
+  for (p = 0; p < 3; p++)
+    memset (counts[p], 0, sizeof seen);
+  while (readdir (dir_fd, name))
+    for (p = 0; p < 3; p++)
+      if ((i = entry_index (name, prefixes[p])) >= 0)
+        counts[p][i]++;
+  for (p = 0; p < 3; p++)
+    for (i = 0; i < FILE_CNT; i++)
+      if (counts[p][i] != (p < prefix_cnt))
+        fail ("readdir listed \"%c%d\" %d times",
+              prefixes[p], i, counts[p][i]);
+}
+
+void
+test_main (void) 
+{
+  struct dirent ents[BATCH];
+  unsigned cookie = 0;
+  int dir_fd, batches = 0;
+  int i, n;
+
+  msg ("create %d files", FILE_CNT);
+  create_files ('f', inumbers);
+
+  CHECK ((dir_fd = open ("/")) > 1, "open \"/\"");
+  CHECK (isdir (dir_fd), "isdir \"/\"");
+
+  msg ("list \"/\" with getdents");
+  while ((n = getdents (dir_fd, ents, BATCH, &cookie)) > 0)
+    {
+      for (i = 0; i < n; i++)
+        {
+          int idx;
+
+          if ((idx = entry_index (ents[i].name, 'g')) >= 0)
+            added_seen[idx]++;
+          if ((idx = entry_index (ents[i].name, 'f')) < 0)
+            continue;
+          if (ents[i].type != DIRENT_FILE)
+            fail ("\"%s\" has type %d", ents[i].name, ents[i].type);
+          if ((int) ents[i].inumber != inumbers[idx])
+            fail ("\"%s\" has inumber %u, expected %d",
+                  ents[i].name, ents[i].inumber, inumbers[idx]);
+          seen[idx]++;
+        }
+      if (++batches == 1)
+        create_files ('g', NULL);
+    }
+  CHECK (n == 0, "getdents reached end of directory");
+  CHECK (getdents (dir_fd, ents, BATCH, &cookie) == 0,
+         "getdents stays at end of directory");
+
+  for (i = 0; i < FILE_CNT; i++)
+    {
+      if (seen[i] != 1)
+        fail ("\"f%d\" listed %d times", i, seen[i]);
+      if (added_seen[i] > 1)
+        fail ("\"g%d\" listed %d times", i, added_seen[i]);
+    }
+  msg ("no file listed twice");
+
+  check_readdir (dir_fd, 2);
+  msg ("readdir listed every file once");
+
+  CHECK (getdents (dir_fd + 100, ents, BATCH, &cookie) == -1,
+         "getdents on bad fd");
+  msg ("close \"/\"");
+  close (dir_fd);
+
+  /* Buckets chained during the listing split again now. */
+  msg ("create %d more files", FILE_CNT);
+  create_files ('h', NULL);
+  CHECK ((dir_fd = open ("/")) > 1, "open \"/\" again");
+  check_readdir (dir_fd, 3);
+  msg ("readdir listed every file once");
+  msg ("close \"/\"");
+  close (dir_fd);
+}
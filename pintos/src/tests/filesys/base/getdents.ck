@@ -0,0 +1,23 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(getdents) begin
+(getdents) create 60 files
+(getdents) open "/"
+(getdents) isdir "/"
+(getdents) list "/" with getdents
+(getdents) getdents reached end of directory
+(getdents) getdents stays at end of directory
+(getdents) no file listed twice
+(getdents) readdir listed every file once
+(getdents) getdents on bad fd
+(getdents) close "/"
+(getdents) create 60 more files
+(getdents) open "/" again
+(getdents) readdir listed every file once
+(getdents) close "/"
+(getdents) end
+EOF
+pass;
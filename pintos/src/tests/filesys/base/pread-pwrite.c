@@ -0,0 +1,59 @@
+/* Writes records to a file in reverse order with pwrite() and
+   reads them back in forward order with pread(), then verifies
+   that neither call moved the file position.  Finally checks that
+   transfers reaching past the largest file offset fail, whether
+   the offset is given or comes from the file position. */
+
+#include <random.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define RECORD_SIZE 100
+#define RECORD_CNT 20
+
+static char buf[RECORD_SIZE * RECORD_CNT];
+static char record[RECORD_SIZE];
+
+void
+test_main (void) 
+{
+  const char *file_name = "records";
+  int fd;
+  int i;
+
+  CHECK (create (file_name, 0), "create \"%s\"", file_name);
+  CHECK ((fd = open (file_name)) > 1, "open \"%s\"", file_name);
+
+  random_bytes (buf, sizeof buf);
+  msg ("pwrite %d records in reverse order", RECORD_CNT);
+  for (i = RECORD_CNT - 1; i >= 0; i--)
+    if (pwrite (fd, buf + i * RECORD_SIZE, RECORD_SIZE, i * RECORD_SIZE)
+        != RECORD_SIZE)
+      fail ("pwrite of record %d failed", i);
+
+  msg ("pread %d records", RECORD_CNT);
+  for (i = 0; i < RECORD_CNT; i++)
+    {
+      if (pread (fd, record, RECORD_SIZE, i * RECORD_SIZE) != RECORD_SIZE)
+        fail ("pread of record %d failed", i);
+      compare_bytes (record, buf + i * RECORD_SIZE, RECORD_SIZE,
+                     i * RECORD_SIZE, file_name);
+    }
+
+  CHECK (tell (fd) == 0, "file position unchanged");
+  CHECK (filesize (fd) == sizeof buf, "file size is %zu", sizeof buf);
+
+  CHECK (pwrite (fd, record, RECORD_SIZE, 0x7ffffff6) == -1,
+         "pwrite past largest offset");
+  CHECK (pread (fd, record, RECORD_SIZE, 0x80000000) == -1,
+         "pread past largest offset");
+  seek (fd, 0x7ffffff6);
+  CHECK (write (fd, record, RECORD_SIZE) == -1,
+         "write past largest offset");
+  CHECK (read (fd, record, RECORD_SIZE) == -1,
+         "read past largest offset");
+  CHECK (filesize (fd) == sizeof buf, "file size is still %zu", sizeof buf);
+  msg ("close \"%s\"", file_name);
+  close (fd);
+}
@@ -0,0 +1,21 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(pread-pwrite) begin
+(pread-pwrite) create "records"
+(pread-pwrite) open "records"
+(pread-pwrite) pwrite 20 records in reverse order
+(pread-pwrite) pread 20 records
+(pread-pwrite) file position unchanged
+(pread-pwrite) file size is 2000
+(pread-pwrite) pwrite past largest offset
+(pread-pwrite) pread past largest offset
+(pread-pwrite) write past largest offset
+(pread-pwrite) read past largest offset
+(pread-pwrite) file size is still 2000
+(pread-pwrite) close "records"
+(pread-pwrite) end
+EOF
+pass;
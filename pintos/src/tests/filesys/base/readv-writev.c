@@ -0,0 +1,50 @@
+/* Writes a file from several buffers with one writev() and
+   reads it back into differently sized buffers with one
+   readv(). */
+
+#include <random.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char data[1500];
+static char in[3][500];
+
+void
+test_main (void) 
+{
+  const char *file_name = "vectored";
+  struct iovec wv[4], rv[3];
+  int fd;
+  int i;
+
+  random_bytes (data, sizeof data);
+  wv[0].iov_base = data;
+  wv[0].iov_len = 100;
+  wv[1].iov_base = data + 100;
+  wv[1].iov_len = 0;
+  wv[2].iov_base = data + 100;
+  wv[2].iov_len = 900;
+  wv[3].iov_base = data + 1000;
+  wv[3].iov_len = 500;
+  for (i = 0; i < 3; i++)
+    {
+      rv[i].iov_base = in[i];
+      rv[i].iov_len = sizeof in[i];
+    }
+
+  CHECK (create (file_name, 0), "create \"%s\"", file_name);
+  CHECK ((fd = open (file_name)) > 1, "open \"%s\"", file_name);
+  CHECK (writev (fd, wv, 4) == sizeof data, "writev 4 buffers");
+  CHECK (tell (fd) == sizeof data, "file position advanced");
+  msg ("seek \"%s\" to 0", file_name);
+  seek (fd, 0);
+  CHECK (readv (fd, rv, 3) == sizeof data, "readv 3 buffers");
+  for (i = 0; i < 3; i++)
+    compare_bytes (in[i], data + i * sizeof in[i], sizeof in[i],
+                   i * sizeof in[i], file_name);
+  CHECK (readv (fd, rv, 3) == 0, "readv at end of file");
+  msg ("close \"%s\"", file_name);
+  close (fd);
+}
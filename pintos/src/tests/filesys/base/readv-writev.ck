@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(readv-writev) begin
+(readv-writev) create "vectored"
+(readv-writev) open "vectored"
+(readv-writev) writev 4 buffers
+(readv-writev) file position advanced
+(readv-writev) seek "vectored" to 0
+(readv-writev) readv 3 buffers
+(readv-writev) readv at end of file
+(readv-writev) close "vectored"
+(readv-writev) end
+EOF
+pass;
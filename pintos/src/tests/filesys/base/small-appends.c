@@ -0,0 +1,49 @@
+/* Appends many short records to a file, which the file system
+   gathers in memory until each sector fills up, and checks that
+   the size and the data read through a second file descriptor
+   keep up with the appends as they are made, then that the
+   whole file is intact once it has been closed. */
+
+#include <random.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define RECORD_SIZE 7
+#define RECORD_CNT 700
+
+static char buf[RECORD_SIZE * RECORD_CNT];
+
+void
+test_main (void) 
+{
+  char record[RECORD_SIZE];
+  int wfd, rfd;
+  size_t i;
+
+  random_bytes (buf, sizeof buf);
+  CHECK (create ("log", 0), "create \"log\"");
+  CHECK ((wfd = open ("log")) > 1, "open \"log\" for appending");
+  CHECK ((rfd = open ("log")) > 1, "open \"log\" for reading");
+
+  msg ("append %d records of %d bytes", RECORD_CNT, RECORD_SIZE);
+  quiet = true;
+  for (i = 0; i < RECORD_CNT; i++) 
+    {
+      size_t ofs = i * RECORD_SIZE;
+
+      CHECK (write (wfd, buf + ofs, RECORD_SIZE) == RECORD_SIZE,
+             "append record %zu", i);
+      CHECK (filesize (rfd) == (int) (ofs + RECORD_SIZE),
+             "filesize after record %zu", i);
+      CHECK (pread (rfd, record, RECORD_SIZE, ofs) == RECORD_SIZE,
+             "read back record %zu", i);
+      compare_bytes (record, buf + ofs, RECORD_SIZE, ofs, "log");
+    }
+  quiet = false;
+
+  msg ("close \"log\"");
+  close (wfd);
+  close (rfd);
+  check_file ("log", buf, sizeof buf);
+}
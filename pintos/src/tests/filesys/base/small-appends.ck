@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(small-appends) begin
+(small-appends) create "log"
+(small-appends) open "log" for appending
+(small-appends) open "log" for reading
+(small-appends) append 700 records of 7 bytes
+(small-appends) close "log"
+(small-appends) open "log" for verification
+(small-appends) verified contents of "log"
+(small-appends) close "log"
+(small-appends) end
+EOF
+pass;
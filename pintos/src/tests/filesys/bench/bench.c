@@ -0,0 +1,24 @@
+/* Timing helpers for the file system benchmarks. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/filesys/bench/bench.h"
+#include "tests/lib.h"
+
+/* Returns the time at which a phase starts. */
+unsigned
+bench_start (void) 
+{
+  return ticks ();
+}
+
+/* Prints a timing line for PHASE, which started at START and
+   moved BYTES bytes in OPS operations. */
+void
+bench_report (const char *phase, unsigned start, size_t bytes, size_t ops) 
+{
+  unsigned elapsed = ticks () - start;
+
+  printf ("bench: %s %s bytes=%zu ops=%zu ticks=%u\n",
+          test_name, phase, bytes, ops, elapsed);
+}
@@ -0,0 +1,21 @@
+#ifndef TESTS_FILESYS_BENCH_BENCH_H
+#define TESTS_FILESYS_BENCH_BENCH_H
+
+#include <stddef.h>
+
+/* Each timed phase of a benchmark prints one line of the form
+
+     bench: <program> <phase> bytes=<B> ops=<N> ticks=<T>
+
+   on the console, where B is the number of bytes of file data
+   moved, N is the number of system calls or file operations
+   timed, and T is the number of timer ticks that elapsed.
+   Other output follows the usual test conventions, so these
+   lines can be grepped out of a run and compared across kernel
+   builds. */
+
+unsigned bench_start (void);
+void bench_report (const char *phase, unsigned start,
+                   size_t bytes, size_t ops);
+
+#endif /* tests/filesys/bench/bench.h */
@@ -0,0 +1,29 @@
+use strict;
+use warnings;
+use tests::tests;
+
+# Checks a benchmark run.  The timing lines vary from run to run,
+# so they are only checked for form and number (at least
+# $min_lines of them); the rest of the output must match
+# $expected exactly, as for check_expected().
+sub check_bench {
+    my ($min_lines, $expected) = @_;
+    our ($test);
+
+    my (@output) = read_text_file ("$test.output");
+    common_checks ("run", @output);
+
+    my (@timing) = grep (/^bench: /, @output);
+    foreach my $line (@timing) {
+	fail "Malformed timing line: $line\n"
+	  if $line !~ /^bench: \S+ \S+ bytes=\d+ ops=\d+ ticks=\d+$/;
+    }
+    fail "Expected at least $min_lines timing lines, found "
+      . scalar (@timing) . ".\n"
+	if @timing < $min_lines;
+
+    @output = grep (!/^bench: /, @output);
+    compare_output ("run", IGNORE_EXIT_CODES => 1, \@output, $expected);
+}
+
+1;
@@ -0,0 +1,68 @@
+/* Times growing a directory to many entries, looking names up
+   in it, and shrinking it again.  The file system has a single
+   directory, so a large one, which splits its hash buckets and
+   doubles its table several times over, stands in for a deep
+   tree. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/filesys/bench/bench.h"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define FILE_CNT 800
+#define WALK_CNT 4
+
+static void
+file_name (char *name, size_t size, int i) 
+{
+  snprintf (name, size, "big-%d", i);
+}
+
+void
+test_main (void) 
+{
+  char name[32];
+  unsigned start;
+  int i, pass, fd;
+
+  msg ("timing a directory of %d files", FILE_CNT);
+  quiet = true;
+
+  start = bench_start ();
+  for (i = 0; i < FILE_CNT; i++) 
+    {
+      file_name (name, sizeof name, i);
+      CHECK (create (name, 0), "create \"%s\"", name);
+    }
+  bench_report ("create", start, 0, FILE_CNT);
+
+  start = bench_start ();
+  for (pass = 0; pass < WALK_CNT; pass++)
+    for (i = 0; i < FILE_CNT; i++) 
+      {
+        file_name (name, sizeof name, i);
+        CHECK ((fd = open (name)) > 1, "open \"%s\"", name);
+        close (fd);
+      }
+  bench_report ("lookup", start, 0, WALK_CNT * FILE_CNT);
+
+  start = bench_start ();
+  for (i = 0; i < FILE_CNT; i++) 
+    {
+      snprintf (name, sizeof name, "none-%d", i);
+      CHECK (open (name) == -1, "open \"%s\" (must return -1)", name);
+    }
+  bench_report ("lookup-miss", start, 0, FILE_CNT);
+
+  start = bench_start ();
+  for (i = 0; i < FILE_CNT; i++) 
+    {
+      file_name (name, sizeof name, i);
+      CHECK (remove (name), "remove \"%s\"", name);
+    }
+  bench_report ("remove", start, 0, FILE_CNT);
+
+  quiet = false;
+  CHECK (open ("big-0") == -1, "open \"big-0\" (must return -1)");
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::filesys::bench::bench;
+check_bench (4, [<<'EOF']);
+(big-dir) begin
+(big-dir) timing a directory of 800 files
+(big-dir) open "big-0" (must return -1)
+(big-dir) end
+EOF
+pass;
@@ -0,0 +1,71 @@
+/* Child process for multi-rw.
+   Children with an index below WRITER_CNT rewrite their slice of
+   the shared file with the same data it already holds, so that
+   readers always see the contents our parent wrote.  The others
+   read the whole file, checking what they read. */
+
+#include <random.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <syscall.h>
+#include "tests/filesys/bench/bench.h"
+#include "tests/filesys/bench/multi-rw.h"
+#include "tests/lib.h"
+
+const char *test_name = "child-bench-rw";
+
+static char buf1[FILE_SIZE];
+static char buf2[READ_SIZE];
+
+int
+main (int argc, const char *argv[]) 
+{
+  char phase[32];
+  unsigned start;
+  int child_idx;
+  int pass;
+  size_t ofs;
+  int fd;
+
+  quiet = true;
+
+  CHECK (argc == 2, "argc must be 2, actually %d", argc);
+  child_idx = atoi (argv[1]);
+
+  random_init (0);
+  random_bytes (buf1, sizeof buf1);
+
+  CHECK ((fd = open (file_name)) > 1, "open \"%s\"", file_name);
+  start = bench_start ();
+  if (child_idx < WRITER_CNT) 
+    {
+      size_t slice = FILE_SIZE / WRITER_CNT;
+      size_t first = child_idx * slice;
+
+      for (pass = 0; pass < PASS_CNT; pass++)
+        for (ofs = first; ofs < first + slice; ofs += WRITE_SIZE)
+          CHECK (pwrite (fd, buf1 + ofs, WRITE_SIZE, ofs) == WRITE_SIZE,
+                 "write %d bytes at offset %zu in \"%s\"",
+                 WRITE_SIZE, ofs, file_name);
+      snprintf (phase, sizeof phase, "writer-%d", child_idx);
+      bench_report (phase, start, PASS_CNT * slice,
+                    PASS_CNT * slice / WRITE_SIZE);
+    }
+  else 
+    {
+      for (pass = 0; pass < PASS_CNT; pass++)
+        for (ofs = 0; ofs < FILE_SIZE; ofs += READ_SIZE) 
+          {
+            CHECK (pread (fd, buf2, READ_SIZE, ofs) == READ_SIZE,
+                   "read %d bytes at offset %zu in \"%s\"",
+                   READ_SIZE, ofs, file_name);
+            compare_bytes (buf2, buf1 + ofs, READ_SIZE, ofs, file_name);
+          }
+      snprintf (phase, sizeof phase, "reader-%d", child_idx);
+      bench_report (phase, start, PASS_CNT * FILE_SIZE,
+                    PASS_CNT * FILE_SIZE / READ_SIZE);
+    }
+  close (fd);
+
+  return child_idx;
+}
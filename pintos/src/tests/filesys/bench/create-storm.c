@@ -0,0 +1,64 @@
+/* Times a storm of small-file operations: creating and filling
+   many small files, then opening each one to read its size,
+   then deleting them all. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/filesys/bench/bench.h"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define FILE_CNT 200
+#define FILE_SIZE 100
+
+static char data[FILE_SIZE];
+
+static void
+file_name (char *name, size_t size, int i) 
+{
+  snprintf (name, size, "storm-%d", i);
+}
+
+void
+test_main (void) 
+{
+  char name[32];
+  unsigned start;
+  int i, fd;
+
+  msg ("timing %d small files", FILE_CNT);
+  quiet = true;
+
+  start = bench_start ();
+  for (i = 0; i < FILE_CNT; i++) 
+    {
+      file_name (name, sizeof name, i);
+      CHECK (create (name, 0), "create \"%s\"", name);
+      CHECK ((fd = open (name)) > 1, "open \"%s\"", name);
+      CHECK (write (fd, data, FILE_SIZE) == FILE_SIZE,
+             "write \"%s\"", name);
+      close (fd);
+    }
+  bench_report ("create", start, FILE_CNT * FILE_SIZE, FILE_CNT);
+
+  start = bench_start ();
+  for (i = 0; i < FILE_CNT; i++) 
+    {
+      file_name (name, sizeof name, i);
+      CHECK ((fd = open (name)) > 1, "open \"%s\"", name);
+      CHECK (filesize (fd) == FILE_SIZE, "filesize \"%s\"", name);
+      close (fd);
+    }
+  bench_report ("stat", start, 0, FILE_CNT);
+
+  start = bench_start ();
+  for (i = 0; i < FILE_CNT; i++) 
+    {
+      file_name (name, sizeof name, i);
+      CHECK (remove (name), "remove \"%s\"", name);
+    }
+  bench_report ("delete", start, 0, FILE_CNT);
+
+  quiet = false;
+  CHECK (open ("storm-0") == -1, "open \"storm-0\" (must return -1)");
+}
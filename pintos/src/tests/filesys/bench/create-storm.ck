@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::filesys::bench::bench;
+check_bench (3, [<<'EOF']);
+(create-storm) begin
+(create-storm) timing 200 small files
+(create-storm) open "storm-0" (must return -1)
+(create-storm) end
+EOF
+pass;
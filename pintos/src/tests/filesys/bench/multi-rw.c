@@ -0,0 +1,40 @@
+/* Times several processes hammering one file at once.  The
+   first WRITER_CNT children each rewrite their own slice of the
+   file in small chunks while the rest read the whole file over
+   and over.  Each child reports its own timing; we report the
+   time for the whole group. */
+
+#include <random.h>
+#include <syscall.h>
+#include "tests/filesys/bench/bench.h"
+#include "tests/filesys/bench/multi-rw.h"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char buf[FILE_SIZE];
+
+void
+test_main (void) 
+{
+  pid_t children[CHILD_CNT];
+  unsigned start;
+  int fd;
+
+  random_init (0);
+  random_bytes (buf, sizeof buf);
+  CHECK (create (file_name, 0), "create \"%s\"", file_name);
+  CHECK ((fd = open (file_name)) > 1, "open \"%s\"", file_name);
+  CHECK (write (fd, buf, sizeof buf) == sizeof buf,
+         "write %d kB to \"%s\"", FILE_SIZE / 1024, file_name);
+  msg ("close \"%s\"", file_name);
+  close (fd);
+
+  start = bench_start ();
+  exec_children ("child-bench-rw", children, CHILD_CNT);
+  wait_children (children, CHILD_CNT);
+  bench_report ("total", start, PASS_CNT * FILE_SIZE * (1 + READER_CNT),
+                PASS_CNT * (FILE_SIZE / WRITE_SIZE
+                            + READER_CNT * FILE_SIZE / READ_SIZE));
+
+  check_file (file_name, buf, sizeof buf);
+}
@@ -0,0 +1,25 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::filesys::bench::bench;
+check_bench (5, [<<'EOF']);
+(multi-rw) begin
+(multi-rw) create "shared"
+(multi-rw) open "shared"
+(multi-rw) write 64 kB to "shared"
+(multi-rw) close "shared"
+(multi-rw) exec child 1 of 4: "child-bench-rw 0"
+(multi-rw) exec child 2 of 4: "child-bench-rw 1"
+(multi-rw) exec child 3 of 4: "child-bench-rw 2"
+(multi-rw) exec child 4 of 4: "child-bench-rw 3"
+(multi-rw) wait for child 1 of 4 returned 0 (expected 0)
+(multi-rw) wait for child 2 of 4 returned 1 (expected 1)
+(multi-rw) wait for child 3 of 4 returned 2 (expected 2)
+(multi-rw) wait for child 4 of 4 returned 3 (expected 3)
+(multi-rw) open "shared" for verification
+(multi-rw) verified contents of "shared"
+(multi-rw) close "shared"
+(multi-rw) end
+EOF
+pass;
@@ -0,0 +1,13 @@
+#ifndef TESTS_FILESYS_BENCH_MULTI_RW_H
+#define TESTS_FILESYS_BENCH_MULTI_RW_H
+
+#define FILE_SIZE (64 * 1024)
+#define WRITER_CNT 2
+#define READER_CNT 2
+#define CHILD_CNT (WRITER_CNT + READER_CNT)
+#define PASS_CNT 8
+#define WRITE_SIZE 512
+#define READ_SIZE 4096
+static const char file_name[] = "shared";
+
+#endif /* tests/filesys/bench/multi-rw.h */
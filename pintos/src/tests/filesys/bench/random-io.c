@@ -0,0 +1,74 @@
+/* Times random 512-byte and 4 kB reads and writes within a
+   256 kB file.  Offsets are aligned to the transfer size and
+   drawn from a fixed seed, so every run touches the same
+   blocks in the same order. */
+
+#include <random.h>
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/filesys/bench/bench.h"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define FILE_SIZE (256 * 1024)
+#define OP_CNT 512
+
+static const size_t block_sizes[] = {512, 4096};
+#define BLOCK_SIZE_CNT (sizeof block_sizes / sizeof *block_sizes)
+
+static char buf[FILE_SIZE];
+static char block[4096];
+
+void
+test_main (void) 
+{
+  unsigned start;
+  size_t i, j;
+  int fd;
+
+  random_init (0);
+  random_bytes (buf, sizeof buf);
+  CHECK (create ("random", 0), "create \"random\"");
+  CHECK ((fd = open ("random")) > 1, "open \"random\"");
+
+  start = bench_start ();
+  CHECK (write (fd, buf, FILE_SIZE) == FILE_SIZE,
+         "write %d kB to \"random\"", FILE_SIZE / 1024);
+  bench_report ("fill", start, FILE_SIZE, 1);
+
+  msg ("timing %d random operations per block size", OP_CNT);
+  quiet = true;
+  for (i = 0; i < BLOCK_SIZE_CNT; i++) 
+    {
+      size_t block_size = block_sizes[i];
+      size_t block_cnt = FILE_SIZE / block_size;
+      char phase[32];
+
+      random_init (block_size);
+      start = bench_start ();
+      for (j = 0; j < OP_CNT; j++) 
+        {
+          size_t ofs = random_ulong () % block_cnt * block_size;
+          CHECK (pread (fd, block, block_size, ofs) == (int) block_size,
+                 "read %zu bytes at offset %zu", block_size, ofs);
+        }
+      snprintf (phase, sizeof phase, "read-%zu", block_size);
+      bench_report (phase, start, OP_CNT * block_size, OP_CNT);
+
+      random_init (block_size + 1);
+      start = bench_start ();
+      for (j = 0; j < OP_CNT; j++) 
+        {
+          size_t ofs = random_ulong () % block_cnt * block_size;
+          CHECK (pwrite (fd, buf + ofs, block_size, ofs) == (int) block_size,
+                 "write %zu bytes at offset %zu", block_size, ofs);
+        }
+      snprintf (phase, sizeof phase, "write-%zu", block_size);
+      bench_report (phase, start, OP_CNT * block_size, OP_CNT);
+    }
+  quiet = false;
+
+  msg ("close \"random\"");
+  close (fd);
+  check_file ("random", buf, sizeof buf);
+}
@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::filesys::bench::bench;
+check_bench (5, [<<'EOF']);
+(random-io) begin
+(random-io) create "random"
+(random-io) open "random"
+(random-io) write 256 kB to "random"
+(random-io) timing 512 random operations per block size
+(random-io) close "random"
+(random-io) open "random" for verification
+(random-io) verified contents of "random"
+(random-io) close "random"
+(random-io) end
+EOF
+pass;
@@ -0,0 +1,79 @@
+/* Times sequential writes and reads of a 256 kB file at several
+   chunk sizes.  Each chunk size gets a fresh file, which is
+   written from empty (growing it), rewritten in place, read back
+   and then removed. */
+
+#include <random.h>
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/filesys/bench/bench.h"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define FILE_SIZE (256 * 1024)
+
+static const size_t chunk_sizes[] = {64, 512, 4096, 16384};
+#define CHUNK_SIZE_CNT (sizeof chunk_sizes / sizeof *chunk_sizes)
+
+static char buf[FILE_SIZE];
+
+static void
+write_file (int fd, size_t chunk_size, const char *phase) 
+{
+  unsigned start;
+  size_t ofs;
+
+  seek (fd, 0);
+  start = bench_start ();
+  for (ofs = 0; ofs < FILE_SIZE; ofs += chunk_size)
+    if (write (fd, buf + ofs, chunk_size) != (int) chunk_size)
+      fail ("write %zu bytes at offset %zu failed", chunk_size, ofs);
+  bench_report (phase, start, FILE_SIZE, FILE_SIZE / chunk_size);
+}
+
+static void
+read_file (int fd, size_t chunk_size, const char *phase) 
+{
+  static char block[16384];
+  unsigned start;
+  size_t ofs;
+
+  seek (fd, 0);
+  start = bench_start ();
+  for (ofs = 0; ofs < FILE_SIZE; ofs += chunk_size)
+    if (read (fd, block, chunk_size) != (int) chunk_size)
+      fail ("read %zu bytes at offset %zu failed", chunk_size, ofs);
+  bench_report (phase, start, FILE_SIZE, FILE_SIZE / chunk_size);
+}
+
+void
+test_main (void) 
+{
+  size_t i;
+
+  random_bytes (buf, sizeof buf);
+  msg ("timing %d kB sequential I/O at %zu chunk sizes",
+       FILE_SIZE / 1024, CHUNK_SIZE_CNT);
+  quiet = true;
+  for (i = 0; i < CHUNK_SIZE_CNT; i++) 
+    {
+      size_t chunk_size = chunk_sizes[i];
+      char phase[32];
+      int fd;
+
+      CHECK (create ("seq", 0), "create \"seq\"");
+      CHECK ((fd = open ("seq")) > 1, "open \"seq\"");
+
+      snprintf (phase, sizeof phase, "append-%zu", chunk_size);
+      write_file (fd, chunk_size, phase);
+      snprintf (phase, sizeof phase, "rewrite-%zu", chunk_size);
+      write_file (fd, chunk_size, phase);
+      snprintf (phase, sizeof phase, "read-%zu", chunk_size);
+      read_file (fd, chunk_size, phase);
+
+      close (fd);
+      CHECK (remove ("seq"), "remove \"seq\"");
+    }
+  quiet = false;
+  msg ("done");
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::filesys::bench::bench;
+check_bench (12, [<<'EOF']);
+(seq-rw) begin
+(seq-rw) timing 256 kB sequential I/O at 4 chunk sizes
+(seq-rw) done
+(seq-rw) end
+EOF
+pass;
@@ -34,11 +34,13 @@
 #ifdef FILESYS
 #include "devices/block.h"
 #include "devices/ide.h"
+#include "filesys/cache.h"
 #include "filesys/filesys.h"
 #include "filesys/fsutil.h"
 #endif
 #ifdef VM
 #include "vm/swap.h"
+#include "vm/frame.h"
 #endif
 
 /* Page directory with kernel mappings only. */
@@ -49,7 +51,8 @@ uint32_t *init_page_dir;
 static bool format_filesys;
 
 /* -filesys, -scratch, -swap: Names of block devices to use,
-   overriding the defaults. */
+   overriding the defaults.  -swap may name several devices,
+   separated by commas. */
 static const char *filesys_bdev_name;
 static const char *scratch_bdev_name;
 #ifdef VM
@@ -250,9 +253,19 @@ parse_options (char **argv)
         filesys_bdev_name = value;
       else if (!strcmp (name, "-scratch"))
         scratch_bdev_name = value;
+      else if (!strcmp (name, "-wb-age"))
+        cache_set_flush_age (atoi (value));
 #ifdef VM
       else if (!strcmp (name, "-swap"))
         swap_bdev_name = value;
+      else if (!strcmp (name, "-evict"))
+        {
+          if (value == NULL || !set_evict_policy (value))
+            PANIC ("unknown page replacement policy `%s' (use -h for help)",
+                   value);
+        }
+      else if (!strcmp (name, "-prefault"))
+        process_set_prefault (true, value != NULL ? atoi (value) * 1024 : 0);
 #endif
 #endif
       else if (!strcmp (name, "-rs"))
@@ -318,6 +331,7 @@ run_actions (char **argv)
       {"rm", 2, fsutil_rm},
       {"extract", 1, fsutil_extract},
       {"append", 2, fsutil_append},
+      {"fsstat", 1, fsutil_fsstat},
 #endif
       {NULL, 0, NULL},
     };
@@ -364,6 +378,7 @@ usage (void)
           "  ls                 List files in the root directory.\n"
           "  cat FILE           Print FILE to the console.\n"
           "  rm FILE            Delete FILE.\n"
+          "  fsstat             Print file system statistics at shutdown.\n"
           "Use these actions indirectly via `pintos' -g and -p options:\n"
           "  extract            Untar from scratch device into file system.\n"
           "  append FILE        Append FILE to tar file on scratch device.\n"
@@ -376,8 +391,15 @@ usage (void)
           "  -f                 Format file system device during startup.\n"
           "  -filesys=BDEV      Use BDEV for file system instead of default.\n"
           "  -scratch=BDEV      Use BDEV for scratch instead of default.\n"
+          "  -wb-age=MS         Write cached data back to disk once it has\n"
+          "                     been dirty for MS ms (default 1000).\n"
 #ifdef VM
-          "  -swap=BDEV         Use BDEV for swap instead of default.\n"
+          "  -swap=BDEV[,BDEV]  Stripe swap across the given BDEVs instead of\n"
+          "                     every swap device.\n"
+          "  -evict=POLICY      Replace pages with POLICY: fifo (default),\n"
+          "                     clock, aging, or random.\n"
+          "  -prefault[=KB]     Load executables of up to KB kB (default 64)\n"
+          "                     at exec instead of on first access.\n"
 #endif
 #endif
           "  -rs=SEED           Set random number seed to SEED.\n"
@@ -397,8 +419,7 @@ locate_block_devices (void)
   locate_block_device (BLOCK_FILESYS, filesys_bdev_name);
   locate_block_device (BLOCK_SCRATCH, scratch_bdev_name);
 #ifdef VM
-  locate_block_device (BLOCK_SWAP, swap_bdev_name);
-  init_swap ();		// IMTC
+  init_swap (swap_bdev_name);		// IMTC
 #endif
 }
 
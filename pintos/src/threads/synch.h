@@ -44,6 +44,23 @@ void cond_wait (struct condition *, struct lock *);
 void cond_signal (struct condition *, struct lock *);
 void cond_broadcast (struct condition *, struct lock *);
 
+/* Readers-writer lock. */	// IMTS
+struct rwlock
+  {
+    struct lock lock;           /* Protects the fields below. */
+    struct condition readers_ok; /* Signaled when readers may enter. */
+    struct condition writer_ok; /* Signaled when a writer may enter. */
+    int readers;                /* Number of threads reading. */
+    int waiting_writers;        /* Number of writers waiting. */
+    bool writer;                /* True while a writer holds it. */
+  };
+
+void rw_init (struct rwlock *);	// IMTC
+void rw_read_acquire (struct rwlock *);	// IMTC
+void rw_read_release (struct rwlock *);	// IMTC
+void rw_write_acquire (struct rwlock *);	// IMTC
+void rw_write_release (struct rwlock *);	// IMTC
+
 void get_locklist (void);	// IMTC
 void free_locklist (struct thread *);	// IMTC
 
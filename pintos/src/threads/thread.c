@@ -850,6 +850,7 @@ add_PCB (struct thread *t, bool is_main)
   pcb_->is_exit = false;
   pcb_->status = DEFAULT_STATUS;
   pcb_->mapid = 0;
+  memset (&pcb_->vmstat, 0, sizeof pcb_->vmstat);
   list_init (&pcb_->child_list);
   list_init (&pcb_->descriptor);
   list_init (&pcb_->maplist);
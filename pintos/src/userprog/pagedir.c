@@ -3,12 +3,49 @@
 #include <stddef.h>
 #include <string.h>
 #include "threads/init.h"
+#include "threads/interrupt.h"
 #include "threads/pte.h"
 #include "threads/palloc.h"
 
 static uint32_t *active_pd (void);
 static void invalidate_pagedir (uint32_t *);
 
+/* Each page table counts its present entries, so that it can
+   be freed as soon as its last mapping is cleared.  The count
+   is kept in the bits the CPU leaves to the OS (PTE_AVL) of the
+   table's first PT_COUNT_PTES entries, PT_COUNT_BITS bits in
+   each, which the CPU ignores and never changes, so it costs no
+   memory.  Pages may be unmapped by a thread other than the
+   owner (e.g. on eviction), so a count and the page table
+   entries it covers are only updated with interrupts off. */
+#define PT_COUNT_BITS 3
+#define PT_COUNT_SHIFT 9
+#define PT_COUNT_PTES 4
+
+/* Returns the number of present entries in page table PT. */
+static unsigned
+pt_count (const uint32_t *pt)
+{
+  unsigned cnt = 0;
+  int i;
+
+  for (i = PT_COUNT_PTES - 1; i >= 0; i--)
+    cnt = (cnt << PT_COUNT_BITS) | (pt[i] & PTE_AVL) >> PT_COUNT_SHIFT;
+  return cnt;
+}
+
+/* Sets the number of present entries in page table PT to CNT. */
+static void
+set_pt_count (uint32_t *pt, unsigned cnt)
+{
+  int i;
+
+  ASSERT (cnt >> (PT_COUNT_BITS * PT_COUNT_PTES) == 0);
+  for (i = 0; i < PT_COUNT_PTES; i++, cnt >>= PT_COUNT_BITS)
+    pt[i] = ((pt[i] & ~(uint32_t) PTE_AVL)
+             | (cnt & ((1 << PT_COUNT_BITS) - 1)) << PT_COUNT_SHIFT);
+}
+
 /* Creates a new page directory that has mappings for kernel
    virtual addresses, but none for user virtual addresses.
    Returns the new page directory, or a null pointer if memory
@@ -106,6 +143,7 @@ bool
 pagedir_set_page (uint32_t *pd, void *upage, void *kpage, bool writable)
 {
   uint32_t *pte;
+  enum intr_level old_level;
 
   ASSERT (pg_ofs (upage) == 0);
   ASSERT (pg_ofs (kpage) == 0);
@@ -113,16 +151,20 @@ pagedir_set_page (uint32_t *pd, void *upage, void *kpage, bool writable)
   ASSERT (vtop (kpage) >> PTSHIFT < init_ram_pages);
   ASSERT (pd != init_page_dir);
 
+  old_level = intr_disable ();
   pte = lookup_page (pd, upage, true);
 
   if (pte != NULL) 
     {
+      uint32_t *pt = pg_round_down (pte);
+
       ASSERT ((*pte & PTE_P) == 0);
-      *pte = pte_create_user (kpage, writable);
-      return true;
+      *pte = pte_create_user (kpage, writable) | (*pte & PTE_AVL);
+      set_pt_count (pt, pt_count (pt) + 1);
     }
-  else
-    return false;
+  intr_set_level (old_level);
+
+  return pte != NULL;
 }
 
 /* Looks up the physical address that corresponds to user virtual
@@ -143,24 +185,45 @@ pagedir_get_page (uint32_t *pd, const void *uaddr)
     return NULL;
 }
 
-/* Marks user virtual page UPAGE "not present" in page
-   directory PD.  Later accesses to the page will fault.  Other
-   bits in the page table entry are preserved.
+/* Removes the mapping for user virtual page UPAGE from page
+   directory PD.  Later accesses to the page will fault.  The
+   page table entry is cleared entirely, so its accessed and
+   dirty bits must be read before calling this function.  If
+   this was the last mapping in its page table, the page table
+   is freed too.
    UPAGE need not be mapped. */
 void
 pagedir_clear_page (uint32_t *pd, void *upage) 
 {
   uint32_t *pte;
+  uint32_t *pt = NULL;
+  enum intr_level old_level;
 
   ASSERT (pg_ofs (upage) == 0);
   ASSERT (is_user_vaddr (upage));
 
+  old_level = intr_disable ();
   pte = lookup_page (pd, upage, false);
   if (pte != NULL && (*pte & PTE_P) != 0)
     {
-      *pte &= ~PTE_P;
+      uint32_t *pde = pd + pd_no (upage);
+      uint32_t *table = pde_get_pt (*pde);
+      unsigned cnt = pt_count (table);
+
+      *pte &= PTE_AVL;
+      ASSERT (cnt > 0);
+      set_pt_count (table, cnt - 1);
+      if (cnt == 1)
+        {
+          pt = table;
+          *pde = 0;
+        }
       invalidate_pagedir (pd);
     }
+  intr_set_level (old_level);
+
+  if (pt != NULL)
+    palloc_free_page (pt);
 }
 
 /* Returns true if the PTE for virtual page VPAGE in PD is dirty,
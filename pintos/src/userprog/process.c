@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <syscall-nr.h>		// IMTC
 #include "userprog/gdt.h"
 #include "userprog/pagedir.h"
 #include "userprog/tss.h"
@@ -21,9 +22,10 @@
 #include "threads/vaddr.h"
 #include "vm/page.h"		// IMTC
 #include "vm/frame.h"		// IMTC
+#include "vm/vmstat.h"		// IMTC
 
 static thread_func start_process NO_RETURN;
-static bool load (const char *cmdline, void (**eip) (void), void **esp, char **save_ptr);
+static bool load (const char *cmdline, void (**eip) (void), void **esp, char **save_ptr, bool prefault);	// IMTC
 int argument_length (char **save_ptr, int *argc);				// IMTC
 void insert_argument_to_array (char *dst, const char *src_, char **save_ptr, int dst_offset, int src_length, int padding);	// IMTC
 void free_mmap_pte_list (struct thread *, struct list *, struct file *);	// IMTC
@@ -31,6 +33,26 @@ void terminate_mmap_list (struct PCB *);	// IMTC
 void terminate_descriptor (struct PCB *);	// IMTC
 void terminate_child (struct PCB *);		// IMTC
 
+// IMTS
+/* Arguments handed to start_process(), packed into one page. */
+struct exec_args
+  {
+    int mode;				/* EXEC_* paging mode. */
+    char cmd_line[PGSIZE - sizeof (int)];
+  };
+
+/* Default for EXEC_DEFAULT: whether to prefault executables, and
+   the largest executable that is prefaulted in full. */
+static bool exec_prefault;		// IMTC
+static off_t prefault_file_max = 64 * 1024;	// IMTC
+
+/* Number of pages of the entry segment that are prefaulted when
+   the executable is too big to prefault in full. */
+#define PREFAULT_ENTRY_PAGES 4		// IMTC
+
+/* Most PT_LOAD segments load() remembers for prefaulting. */
+#define PREFAULT_SEG_MAX 8		// IMTC
+
 /* Starts a new thread running a user program loaded from
    FILENAME.  The new thread may be scheduled (and may even exit)
    before process_execute() returns.  Returns the new process's
@@ -38,7 +60,17 @@ void terminate_child (struct PCB *);		// IMTC
 tid_t
 process_execute (const char *file_name) 
 {
-  char *fn_copy;
+  return process_execute_mode (file_name, EXEC_DEFAULT);	// IMTC
+}
+
+// IMTF
+/* Like process_execute(), but MODE (one of EXEC_DEFAULT,
+   EXEC_LAZY, EXEC_PREFAULT) selects whether the executable is
+   prefaulted during load. */
+tid_t
+process_execute_mode (const char *file_name, int mode)
+{
+  struct exec_args *args;	// IMTC
   char *save_ptr;	// IMTC
   char *temp_file_name;	// IMTC
   int temp_file_length;	// IMTC
@@ -47,10 +79,11 @@ process_execute (const char *file_name)
 
   /* Make a copy of FILE_NAME.
      Otherwise there's a race between the caller and load(). */
-  fn_copy = palloc_get_page (0);
-  if (fn_copy == NULL)
+  args = palloc_get_page (0);		// IMTC
+  if (args == NULL)			// IMTC
     return TID_ERROR;
-  strlcpy (fn_copy, file_name, PGSIZE);
+  args->mode = mode;			// IMTC
+  strlcpy (args->cmd_line, file_name, sizeof args->cmd_line);	// IMTC
 
   temp_file_length = strlen (file_name);	// IMTC
   temp_file_name = (char *) malloc (temp_file_length + 1);	// IMTC
@@ -58,11 +91,11 @@ process_execute (const char *file_name)
   temp_file_name = strtok_r (temp_file_name, " ", &save_ptr);	// IMTC
 
   /* Create a new thread to execute FILE_NAME. */
-  tid = thread_create (temp_file_name, PRI_DEFAULT, start_process, fn_copy);	// IMTC
+  tid = thread_create (temp_file_name, PRI_DEFAULT, start_process, args);	// IMTC
   free (temp_file_name);	// IMTC
 
   if (tid == TID_ERROR)
-    palloc_free_page (fn_copy);
+    palloc_free_page (args);	// IMTC
 
   pcb_ = find_child_PCB (tid);	// IMTC
 
@@ -80,27 +113,31 @@ process_execute (const char *file_name)
 /* A thread function that loads a user process and starts it
    running. */
 static void
-start_process (void *file_name_)
+start_process (void *args_)
 {
   struct thread *t;		// IMTC
-  char *file_name = file_name_;
+  struct exec_args *args = args_;	// IMTC
+  char *file_name;		// IMTC
   char *save_ptr;		// IMTC
   struct intr_frame if_;
   bool success;
+  bool prefault;		// IMTC
 
-  file_name = strtok_r (file_name, " ", &save_ptr);		// IMTC
+  file_name = strtok_r (args->cmd_line, " ", &save_ptr);		// IMTC
+  prefault = (args->mode == EXEC_PREFAULT				// IMTC
+	      || (args->mode == EXEC_DEFAULT && exec_prefault));	// IMTC
 
   /* Initialize interrupt frame and load executable. */
   memset (&if_, 0, sizeof if_);
   if_.gs = if_.fs = if_.es = if_.ds = if_.ss = SEL_UDSEG;
   if_.cs = SEL_UCSEG;
   if_.eflags = FLAG_IF | FLAG_MBS;
-  success = load (file_name, &if_.eip, &if_.esp, &save_ptr);
+  success = load (file_name, &if_.eip, &if_.esp, &save_ptr, prefault);	// IMTC
 
   t = thread_current ();		// IMTC
 
   /* If load failed, quit. */
-  palloc_free_page (file_name);
+  palloc_free_page (args);		// IMTC
   if (!success)
   {
     sema_up (&t->pcb->exec); 
@@ -120,6 +157,18 @@ start_process (void *file_name_)
   NOT_REACHED ();
 }
 
+// IMTF
+/* Sets whether executables started with EXEC_DEFAULT are
+   prefaulted.  Executables of at most FILE_MAX bytes are loaded
+   in full; a FILE_MAX of 0 keeps the current threshold. */
+void
+process_set_prefault (bool enable, off_t file_max)
+{
+  exec_prefault = enable;
+  if (file_max > 0)
+    prefault_file_max = file_max;
+}
+
 /* Waits for thread TID to die and returns its exit status.  If
    it was terminated by the kernel (i.e. killed due to an
    exception), returns -1.  If TID is invalid or if it was not a
@@ -186,9 +235,7 @@ process_exit (void)
   else					// IMTC
   {
     terminate_descriptor (cur->pcb);	// IMTC
-    lock_acquire (&file_lock);		// IMTC
     file_close (cur->pcb->exec_file);	// IMTC
-    lock_release (&file_lock);		// IMTC
     free (cur->pcb);			// IMTC
   }
 
@@ -295,12 +342,17 @@ static bool load_segment (struct file *file, off_t ofs, uint8_t *upage,
                           uint32_t read_bytes, uint32_t zero_bytes,
                           bool writable);
 
+static void prefault_segments (uint8_t *upages[], size_t page_cnts[], int seg_cnt);	// IMTC
+
 /* Loads an ELF executable from FILE_NAME into the current thread.
    Stores the executable's entry point into *EIP
    and its initial stack pointer into *ESP.
+   If PREFAULT is true, a small executable is read in full, and a
+   larger one has the first pages of its entry segment read,
+   before the process starts, instead of one page per fault.
    Returns true if successful, false otherwise. */
 bool
-load (const char *file_name, void (**eip) (void), void **esp, char **save_ptr) 
+load (const char *file_name, void (**eip) (void), void **esp, char **save_ptr, bool prefault)	// IMTC
 {
   struct thread *t = thread_current ();
   struct Elf32_Ehdr ehdr;
@@ -308,6 +360,10 @@ load (const char *file_name, void (**eip) (void), void **esp, char **save_ptr)
   off_t file_ofs;
   bool success = false;
   int i;
+  bool small_file = false;			// IMTC
+  uint8_t *prefault_upages[PREFAULT_SEG_MAX];	// IMTC
+  size_t prefault_pages[PREFAULT_SEG_MAX];	// IMTC
+  int prefault_cnt = 0;				// IMTC
 
   /* Allocate and activate page directory. */
   t->pagedir = pagedir_create ();
@@ -315,7 +371,6 @@ load (const char *file_name, void (**eip) (void), void **esp, char **save_ptr)
     goto done;
   process_activate ();
 
-  lock_acquire (&file_lock);	// IMTC
   /* Open executable file. */
   file = filesys_open (file_name);
   if (file == NULL) 
@@ -339,6 +394,9 @@ load (const char *file_name, void (**eip) (void), void **esp, char **save_ptr)
       goto done; 
     }
 
+  if (prefault)						// IMTC
+    small_file = file_length (file) <= prefault_file_max;	// IMTC
+
   /* Read program headers. */
   file_ofs = ehdr.e_phoff;
   for (i = 0; i < ehdr.e_phnum; i++) 
@@ -391,6 +449,24 @@ load (const char *file_name, void (**eip) (void), void **esp, char **save_ptr)
               if (!load_segment (file, file_page, (void *) mem_page,
                                  read_bytes, zero_bytes, writable))
                 goto done;
+
+              /* Remember which pages to prefault: every page
+                 with file data if the executable is small,
+                 otherwise the first few of the entry segment. */
+              if (prefault && prefault_cnt < PREFAULT_SEG_MAX)	// IMTC
+                {
+                  size_t file_pages = DIV_ROUND_UP (read_bytes, PGSIZE);		// IMTC
+                  bool has_entry = (ehdr.e_entry >= mem_page			// IMTC
+                                    && ehdr.e_entry < mem_page + read_bytes + zero_bytes);	// IMTC
+
+                  if (!small_file && has_entry && file_pages > PREFAULT_ENTRY_PAGES)	// IMTC
+                    file_pages = PREFAULT_ENTRY_PAGES;			// IMTC
+                  if (small_file || has_entry)				// IMTC
+                    {
+                      prefault_upages[prefault_cnt] = (uint8_t *) mem_page;	// IMTC
+                      prefault_pages[prefault_cnt++] = file_pages;		// IMTC
+                    }
+                }
             }
           else
             goto done;
@@ -410,9 +486,29 @@ load (const char *file_name, void (**eip) (void), void **esp, char **save_ptr)
  done:
   /* We arrive here whether the load is successful or not. */
   //file_close (file);
-  lock_release (&file_lock);	// IMTC
+
+  /* Prefault only once all of the segments are set up, just as
+     if the process had faulted them in itself. */
+  if (success)						// IMTC
+    prefault_segments (prefault_upages, prefault_pages, prefault_cnt);	// IMTC
   return success;
 }
+
+// IMTF
+/* Loads the first PAGE_CNTS[I] pages of each segment starting at
+   UPAGES[I], in order, so the executable is read in one
+   sequential pass.  Pages that cannot be loaded now are simply
+   left to be faulted in later. */
+static void
+prefault_segments (uint8_t *upages[], size_t page_cnts[], int seg_cnt)
+{
+  int i;
+  size_t j;
+
+  for (i = 0; i < seg_cnt; i++)
+    for (j = 0; j < page_cnts[i]; j++)
+      prefault_page (upages[i] + j * PGSIZE);
+}
 
 /* load() helpers. */
 
@@ -791,6 +887,7 @@ free_mmap_pte_list (struct thread *t, struct list *l, struct file *f)
 {
   struct list_elem *e;
   struct mmappte_elem *mme;
+  struct vmstat_timer timer;
 
   e = list_begin (l);
 
@@ -803,9 +900,9 @@ free_mmap_pte_list (struct thread *t, struct list *l, struct file *f)
     {
 	if (pagedir_is_dirty (t->pagedir, mme->pte->addr))
 	{
-	  lock_acquire (&file_lock);
+	  vmstat_start (&timer);
 	  file_write_at (f, mme->pte->addr, mme->pte->read_bytes, mme->pte->file_offset);
-	  lock_release (&file_lock);
+	  vmstat_stop (&timer, VMSTAT_WRITEBACK);
 	}
 
 	free_frame (pagedir_get_page (t->pagedir, mme->pte->addr));
@@ -844,9 +941,7 @@ free_mmap_list (mapid_t mapid)
 
   free_mmap_pte_list (t, mmap_ptelist, me->f);
 
-  lock_acquire (&file_lock);
   file_close (me->f);
-  lock_release (&file_lock);
 
   list_remove (&me->elem);
   free (me);
@@ -902,9 +997,7 @@ terminate_child (struct PCB *pcb)
 
   terminate_mmap_list (pcb);
   terminate_descriptor (pcb);
-  lock_acquire (&file_lock);
   file_close (pcb->exec_file);
-  lock_release (&file_lock);
   free (pcb);
 }
 
@@ -2,6 +2,7 @@
 #define USERPROG_PROCESS_H
 
 #include <hash.h>			// IMTC
+#include <vmstat.h>			// IMTC
 #include "threads/thread.h"
 #include "threads/synch.h"		// IMTC
 #include "vm/page.h"			// IMTC
@@ -46,6 +47,7 @@ struct PCB
     struct file *exec_file;
     mapid_t mapid;
     struct list maplist;
+    struct vmstat vmstat;
   };
 
 // IMTS
@@ -57,9 +59,10 @@ struct descriptor_elem
   };
 
 //struct list descriptor;		// IMTC
-struct lock file_lock;		// IMTC
 
 tid_t process_execute (const char *file_name);
+tid_t process_execute_mode (const char *file_name, int mode);	// IMTC
+void process_set_prefault (bool enable, off_t file_max);	// IMTC
 int process_wait (tid_t);
 void process_exit (void);
 void process_activate (void);
@@ -1,6 +1,9 @@
 #include "userprog/syscall.h"
 #include <stdio.h>
+#include <string.h>		// IMTC
 #include <syscall-nr.h>
+#include <iovec.h>			// IMTC
+#include <dirent.h>			// IMTC
 #include "threads/interrupt.h"
 #include "threads/thread.h"
 #include "threads/vaddr.h"		// IMTC
@@ -10,14 +13,18 @@
 #include "userprog/pagedir.h"		// IMTC
 #include "filesys/filesys.h"		// IMTC
 #include "filesys/file.h"		// IMTC
+#include "filesys/directory.h"		// IMTC
+#include "filesys/inode.h"		// IMTC
+#include "filesys/fsstat.h"		// IMTC
 #include "devices/shutdown.h"		// IMTC
 #include "devices/input.h"		// IMTC
+#include "devices/timer.h"		// IMTC
 #include "vm/page.h"			// IMTC
 #include "vm/frame.h"			// IMTC
+#include "vm/vmstat.h"			// IMTC
 
 #define USER_ADDR_MIN ((void *) 0x08048000)	// IMTC
-
-//struct lock file_lock;			// IMTC
+#define GETDENTS_MAX (PGSIZE / sizeof (struct dirent))	// IMTC
 
 static void syscall_handler (struct intr_frame *);
 void sys_halt (void);			// IMTC
@@ -35,6 +42,23 @@ unsigned sys_tell (int fd);				// IMTC
 void sys_close (int fd);				// IMTC
 mapid_t sys_mmap (int fd, void *);			// IMTC
 void sys_munmap (mapid_t mapid);			// IMTC
+bool sys_readdir (int fd, char *name);			// IMTC
+bool sys_isdir (int fd);				// IMTC
+int sys_inumber (int fd);				// IMTC
+bool sys_vmstat (struct vmstat *, bool global);		// IMTC
+pid_t sys_exec_mode (const char *, int mode);		// IMTC
+int sys_pread (int fd, void *, unsigned size, unsigned offset);		// IMTC
+int sys_pwrite (int fd, const void *, unsigned size, unsigned offset);	// IMTC
+int sys_readv (int fd, const struct iovec *, int iovcnt);		// IMTC
+int sys_writev (int fd, const struct iovec *, int iovcnt);		// IMTC
+int sys_copy_file_range (int in_fd, int in_off, int out_fd, int out_off, unsigned len);	// IMTC
+int sys_getdents (int fd, struct dirent *, int cnt, unsigned *cookie);	// IMTC
+int sys_fsync (int fd);					// IMTC
+int sys_open_mode (const char *file, int mode);		// IMTC
+bool sys_fsstat (int fd, struct fsstat *);		// IMTC
+unsigned sys_ticks (void);		// IMTC
+int user_io (struct file *, void *, unsigned size, off_t offset, bool write);	// IMTC
+int get_dir_entries (struct file *, off_t *cookie, struct dirent *, int cnt);	// IMTC
 int set_file (struct file *);				// IMTC
 struct file *get_file (int fd);				// IMTC
 void close_file (int fd);				// IMTC
@@ -44,11 +68,11 @@ unsigned int get_page_vaddr (const void *);		// IMTC
 void get_argument (struct intr_frame *, unsigned int *, int n);	// IMTC
 bool is_valid_vaddr (const void *);			// IMTC
 bool valid_writable_ptr (const void *);			// IMTC
+bool valid_offset (unsigned offset, unsigned size);	// IMTC
 
 void
 syscall_init (void) 
 {
-  lock_init (&file_lock);		// IMTC
   intr_register_int (0x30, 3, INTR_ON, syscall_handler, "syscall");
 }
 
@@ -176,21 +200,106 @@ syscall_handler (struct intr_frame *f UNUSED)
     }
     case SYS_READDIR :
     {
-	printf ("not defined READDIR system call\n");
-	thread_exit ();
-
+	unsigned int argv[2];
+	get_argument (f, argv, 2);
+	f->eax = sys_readdir ((int) argv[0], (char *) argv[1]);
+	break;
     }
     case SYS_ISDIR :
     {
-	printf ("not defined ISDIR system call\n");
-	thread_exit ();
-
+	unsigned int argv[1];
+	get_argument (f, argv, 1);
+	f->eax = sys_isdir ((int) argv[0]);
+	break;
     }
     case SYS_INUMBER :
     {
-	printf ("not defined INUMBER system call\n");
-	thread_exit ();
-
+	unsigned int argv[1];
+	get_argument (f, argv, 1);
+	f->eax = sys_inumber ((int) argv[0]);
+	break;
+    }
+    case SYS_VMSTAT :
+    {
+	unsigned int argv[2];
+	get_argument (f, argv, 2);
+	f->eax = sys_vmstat ((struct vmstat *) argv[0], (bool) argv[1]);
+	break;
+    }
+    case SYS_EXEC_MODE :
+    {
+	unsigned int argv[2];
+	get_argument (f, argv, 2);
+	f->eax = sys_exec_mode ((const char *) argv[0], (int) argv[1]);
+	break;
+    }
+    case SYS_PREAD :
+    {
+	unsigned int argv[4];
+	get_argument (f, argv, 4);
+	f->eax = sys_pread ((int) argv[0], (void *) argv[1], (unsigned) argv[2], (unsigned) argv[3]);
+	break;
+    }
+    case SYS_PWRITE :
+    {
+	unsigned int argv[4];
+	get_argument (f, argv, 4);
+	f->eax = sys_pwrite ((int) argv[0], (const void *) argv[1], (unsigned) argv[2], (unsigned) argv[3]);
+	break;
+    }
+    case SYS_READV :
+    {
+	unsigned int argv[3];
+	get_argument (f, argv, 3);
+	f->eax = sys_readv ((int) argv[0], (const struct iovec *) argv[1], (int) argv[2]);
+	break;
+    }
+    case SYS_WRITEV :
+    {
+	unsigned int argv[3];
+	get_argument (f, argv, 3);
+	f->eax = sys_writev ((int) argv[0], (const struct iovec *) argv[1], (int) argv[2]);
+	break;
+    }
+    case SYS_COPY_FILE_RANGE :
+    {
+	unsigned int argv[5];
+	get_argument (f, argv, 5);
+	f->eax = sys_copy_file_range ((int) argv[0], (int) argv[1], (int) argv[2], (int) argv[3], (unsigned) argv[4]);
+	break;
+    }
+    case SYS_GETDENTS :
+    {
+	unsigned int argv[4];
+	get_argument (f, argv, 4);
+	f->eax = sys_getdents ((int) argv[0], (struct dirent *) argv[1], (int) argv[2], (unsigned *) argv[3]);
+	break;
+    }
+    case SYS_FSYNC :
+    {
+	unsigned int argv[1];
+	get_argument (f, argv, 1);
+	f->eax = sys_fsync ((int) argv[0]);
+	break;
+    }
+    case SYS_OPEN_MODE :
+    {
+	unsigned int argv[2];
+	get_argument (f, argv, 2);
+	f->eax = sys_open_mode ((const char *) argv[0], (int) argv[1]);
+	break;
+    }
+    case SYS_FSSTAT :
+    {
+	unsigned int argv[2];
+	get_argument (f, argv, 2);
+	f->eax = sys_fsstat ((int) argv[0], (struct fsstat *) argv[1]);
+	break;
+    }
+    case SYS_TICKS :
+    {
+	f->eax = sys_ticks ();
+	break;
     }
     default :
     {
@@ -251,9 +360,7 @@ sys_create (const char *file, unsigned initial_size)
 
   get_page_vaddr ((const void *) file);
 
-  lock_acquire (&file_lock);
   success = filesys_create (file, initial_size);
-  lock_release (&file_lock);
 
   return success;
 }
@@ -266,9 +373,7 @@ sys_remove (const char *file)
 
   get_page_vaddr ((const void *) file);
 
-  lock_acquire (&file_lock);
   success = filesys_remove (file);
-  lock_release (&file_lock);
 
   return success;
 }
@@ -282,22 +387,16 @@ sys_open (const char *file)
 
   get_page_vaddr ((const void *) file);
 
-  lock_acquire (&file_lock);
   f = filesys_open (file);
 
   if (f == NULL)
-  {
-    lock_release (&file_lock);
     return ERROR;
-  }
 
   fd = set_file (f);
 
   if (check_executable_file (file))
     file_deny_write (f);
 
-  lock_release (&file_lock);
-
   return fd;
 }
 
@@ -308,17 +407,12 @@ sys_filesize (int fd)
   struct file *f;
   int length;
 
-  lock_acquire (&file_lock);
   f = get_file (fd);
 
   if (f == NULL)
-  {
-    lock_release (&file_lock);
     return ERROR;
-  }
 
   length = file_length (f);
-  lock_release (&file_lock);
 
   return length;
 }
@@ -352,17 +446,13 @@ sys_read (int fd, void *buffer, unsigned size)
   }
   else
   {
-    lock_acquire (&file_lock);
     f = get_file (fd);
 
-    if (f == NULL)
-    {
-	lock_release (&file_lock);
+    if (f == NULL || !valid_offset (file_tell (f), size))
 	return ERROR;
-    }
 
-    _bytes = file_read (f, buffer, size);
-    lock_release (&file_lock);
+    _bytes = user_io (f, buffer, size, file_tell (f), false);
+    file_seek (f, file_tell (f) + _bytes);
 
     return _bytes;
   }
@@ -388,17 +478,13 @@ sys_write (int fd, const void *buffer, unsigned size)
   }
   else
   {
-    lock_acquire (&file_lock);
     f = get_file (fd);
 
-    if (f == NULL)
-    {
-	lock_release (&file_lock);
+    if (f == NULL || !valid_offset (file_tell (f), size))
 	return ERROR;
-    }
 
-    _bytes = file_write (f, buffer, size);
-    lock_release (&file_lock);
+    _bytes = user_io (f, (void *) buffer, size, file_tell (f), true);
+    file_seek (f, file_tell (f) + _bytes);
 
     return _bytes;
   }
@@ -410,17 +496,12 @@ sys_seek (int fd, unsigned position)
 {
   struct file *f;
 
-  lock_acquire (&file_lock);
   f = get_file (fd);
 
-  if (f == NULL)
-  {
-    lock_release (&file_lock);
+  if (f == NULL || position > INT32_MAX)
     return;
-  }
 
   file_seek (f, position);
-  lock_release (&file_lock);
 }
 
 // IMTF
@@ -430,17 +511,12 @@ sys_tell (int fd)
   struct file *f;
   off_t position;
 
-  lock_acquire (&file_lock);
   f = get_file (fd);
 
   if (f == NULL)
-  {
-    lock_release (&file_lock);
     return ERROR;
-  }
 
   position = file_tell (f);
-  lock_release (&file_lock);
 
   return position;
 }
@@ -449,9 +525,7 @@ sys_tell (int fd)
 void
 sys_close (int fd)
 {
-  lock_acquire (&file_lock);
   close_file (fd);
-  lock_release (&file_lock);
 }
 
 // IMTF
@@ -510,6 +584,467 @@ sys_munmap (mapid_t mapid)
   free_mmap_list (mapid);
 }
 
+// IMTF
+bool
+sys_vmstat (struct vmstat *st, bool global)
+{
+  struct vmstat temp;
+
+  get_page_vaddr (st);
+  get_page_vaddr ((uint8_t *) st + sizeof *st - 1);
+
+  if (!valid_writable_ptr (st))
+    sys_exit (ERROR);
+
+  vmstat_get (&temp, global);
+  memcpy (st, &temp, sizeof temp);
+
+  return true;
+}
+
+// IMTF
+pid_t
+sys_exec_mode (const char *cmd_line, int mode)
+{
+  get_page_vaddr ((const void *) cmd_line);
+
+  if (mode != EXEC_DEFAULT && mode != EXEC_LAZY && mode != EXEC_PREFAULT)
+    return ERROR;
+
+  return process_execute_mode (cmd_line, mode);
+}
+
+// IMTF
+int
+sys_pread (int fd, void *buffer, unsigned size, unsigned offset)
+{
+  struct file *f;
+
+  get_page_vaddr (buffer);
+
+  if (!valid_writable_ptr (buffer))
+    sys_exit (ERROR);
+
+  f = get_file (fd);
+
+  if (f == NULL || !valid_offset (offset, size))
+    return ERROR;
+
+  return user_io (f, buffer, size, offset, false);
+}
+
+// IMTF
+int
+sys_pwrite (int fd, const void *buffer, unsigned size, unsigned offset)
+{
+  struct file *f;
+
+  get_page_vaddr (buffer);
+
+  f = get_file (fd);
+
+  if (f == NULL || !valid_offset (offset, size))
+    return ERROR;
+
+  return user_io (f, (void *) buffer, size, offset, true);
+}
+
+// IMTF
+int
+sys_readv (int fd, const struct iovec *iov, int iovcnt)
+{
+  struct file *f = NULL;
+  int total = 0;
+  int _bytes;
+  int i;
+
+  if (iovcnt < 0 || iovcnt > IOV_MAX)
+    return ERROR;
+  if (iovcnt == 0)
+    return 0;
+
+  get_page_vaddr (iov);
+  get_page_vaddr ((const char *) (iov + iovcnt) - 1);
+
+  if (fd != STDIN_FILENO)
+  {
+    f = get_file (fd);
+
+    if (f == NULL)
+      return ERROR;
+  }
+
+  for (i = 0; i < iovcnt; i++)
+  {
+    if (iov[i].iov_len == 0)
+      continue;
+
+    if (f == NULL)
+    {
+	_bytes = sys_read (fd, iov[i].iov_base, iov[i].iov_len);
+    }
+    else
+    {
+	get_page_vaddr (iov[i].iov_base);
+
+	if (!valid_writable_ptr (iov[i].iov_base))
+	  sys_exit (ERROR);
+
+	if (!valid_offset (file_tell (f), iov[i].iov_len))
+	  return total > 0 ? total : ERROR;
+
+	_bytes = user_io (f, iov[i].iov_base, iov[i].iov_len, file_tell (f), false);
+	file_seek (f, file_tell (f) + _bytes);
+    }
+
+    total += _bytes;
+
+    if ((size_t) _bytes < iov[i].iov_len)
+      break;
+  }
+
+  return total;
+}
+
+// IMTF
+int
+sys_writev (int fd, const struct iovec *iov, int iovcnt)
+{
+  struct file *f = NULL;
+  int total = 0;
+  int _bytes;
+  int i;
+
+  if (iovcnt < 0 || iovcnt > IOV_MAX)
+    return ERROR;
+  if (iovcnt == 0)
+    return 0;
+
+  get_page_vaddr (iov);
+  get_page_vaddr ((const char *) (iov + iovcnt) - 1);
+
+  if (fd != STDOUT_FILENO)
+  {
+    f = get_file (fd);
+
+    if (f == NULL)
+      return ERROR;
+  }
+
+  for (i = 0; i < iovcnt; i++)
+  {
+    if (iov[i].iov_len == 0)
+      continue;
+
+    get_page_vaddr (iov[i].iov_base);
+
+    if (f == NULL)
+    {
+	putbuf (iov[i].iov_base, iov[i].iov_len);
+	_bytes = iov[i].iov_len;
+    }
+    else if (!valid_offset (file_tell (f), iov[i].iov_len))
+	return total > 0 ? total : ERROR;
+    else
+    {
+	_bytes = user_io (f, iov[i].iov_base, iov[i].iov_len, file_tell (f), true);
+	file_seek (f, file_tell (f) + _bytes);
+    }
+
+    total += _bytes;
+
+    if ((size_t) _bytes < iov[i].iov_len)
+      break;
+  }
+
+  return total;
+}
+
+// IMTF
+int
+sys_copy_file_range (int in_fd, int in_off, int out_fd, int out_off, unsigned len)
+{
+  struct file *in = get_file (in_fd);
+  struct file *out = get_file (out_fd);
+  off_t in_pos, out_pos;
+  int _bytes;
+
+  if (in == NULL || out == NULL || in_off < -1 || out_off < -1)
+    return ERROR;
+
+  /* An offset of -1 means the file's own position, which is
+     advanced past the data copied. */
+  in_pos = in_off == -1 ? file_tell (in) : in_off;
+  out_pos = out_off == -1 ? file_tell (out) : out_off;
+  if (!valid_offset (in_pos, len) || !valid_offset (out_pos, len))
+    return ERROR;
+
+  /* As on Linux, a range may not be copied onto an overlapping
+     range of the same file, through any pair of descriptors:
+     the copy would read back data it had already written. */
+  if (file_get_inode (in) == file_get_inode (out)
+      && in_pos < out_pos + (off_t) len && out_pos < in_pos + (off_t) len)
+    return ERROR;
+
+  _bytes = file_copy_range (in, in_pos, out, out_pos, len);
+
+  if (in_off == -1)
+    file_seek (in, file_tell (in) + _bytes);
+  if (out_off == -1)
+    file_seek (out, file_tell (out) + _bytes);
+
+  return _bytes;
+}
+
+// IMTF
+bool
+sys_readdir (int fd, char *name)
+{
+  struct file *f;
+  struct dirent ent;
+  off_t cookie;
+
+  get_page_vaddr (name);
+  get_page_vaddr (name + NAME_MAX);
+
+  if (!valid_writable_ptr (name))
+    sys_exit (ERROR);
+
+  f = get_file (fd);
+
+  if (f == NULL)
+    return false;
+
+  /* The file position is the cookie. */
+  cookie = file_tell (f);
+
+  if (get_dir_entries (f, &cookie, &ent, 1) != 1)
+    return false;
+
+  file_seek (f, cookie);
+  strlcpy (name, ent.name, NAME_MAX + 1);
+
+  return true;
+}
+
+// IMTF
+bool
+sys_isdir (int fd)
+{
+  struct file *f = get_file (fd);
+
+  return f != NULL && inode_is_dir (file_get_inode (f));
+}
+
+// IMTF
+int
+sys_inumber (int fd)
+{
+  struct file *f = get_file (fd);
+
+  if (f == NULL)
+    return ERROR;
+
+  return inode_get_inumber (file_get_inode (f));
+}
+
+// IMTF
+int
+sys_getdents (int fd, struct dirent *ents, int cnt, unsigned *cookie)
+{
+  struct file *f;
+  struct dirent *temp;
+  off_t pos;
+  int n;
+
+  if (cnt <= 0)
+    return cnt == 0 ? 0 : ERROR;
+
+  get_page_vaddr (ents);
+  get_page_vaddr ((uint8_t *) (ents + cnt) - 1);
+  get_page_vaddr (cookie);
+  get_page_vaddr ((uint8_t *) (cookie + 1) - 1);
+
+  if (!valid_writable_ptr (ents) || !valid_writable_ptr (cookie))
+    sys_exit (ERROR);
+
+  f = get_file (fd);
+
+  if (f == NULL)
+    return ERROR;
+
+  /* Entries are gathered in a kernel buffer, so that no user
+     page faults while the directory is locked. */
+  if ((size_t) cnt > GETDENTS_MAX)
+    cnt = GETDENTS_MAX;
+
+  temp = malloc (cnt * sizeof *temp);
+
+  if (temp == NULL)
+    return ERROR;
+
+  pos = *cookie;
+  n = get_dir_entries (f, &pos, temp, cnt);
+
+  if (n > 0)
+  {
+    memcpy (ents, temp, n * sizeof *temp);
+    *cookie = pos;
+  }
+
+  free (temp);
+
+  return n;
+}
+
+// IMTF
+int
+sys_fsync (int fd)
+{
+  struct file *f = get_file (fd);
+
+  if (f == NULL)
+    return ERROR;
+
+  file_sync (f);
+
+  return 0;
+}
+
+// IMTF
+int
+sys_open_mode (const char *file, int mode)
+{
+  int fd;
+
+  get_page_vaddr ((const void *) file);
+
+  if ((mode & ~OPEN_DIRECT) != 0)
+    return ERROR;
+
+  fd = sys_open (file);
+
+  if (fd != ERROR && (mode & OPEN_DIRECT))
+    file_set_direct (get_file (fd), true);
+
+  return fd;
+}
+
+// IMTF
+bool
+sys_fsstat (int fd, struct fsstat *st)
+{
+  struct fsstat temp;
+  struct file *f;
+
+  get_page_vaddr (st);
+  get_page_vaddr ((uint8_t *) st + sizeof *st - 1);
+
+  if (!valid_writable_ptr (st))
+    sys_exit (ERROR);
+
+  if (fd == FSSTAT_GLOBAL)
+    fsstat_get (&temp, NULL);
+  else
+  {
+    f = get_file (fd);
+
+    if (f == NULL)
+      return false;
+
+    inode_get_stat (file_get_inode (f), &temp);
+  }
+
+  memcpy (st, &temp, sizeof temp);
+
+  return true;
+}
+
+// IMTF
+/* Returns the number of timer ticks since the OS booted,
+   truncated to 32 bits. */
+unsigned
+sys_ticks (void)
+{
+  return (unsigned) timer_ticks ();
+}
+
+// IMTF
+/* Moves SIZE bytes between user BUFFER and F at OFFSET, one user
+   page at a time, and returns the number of bytes moved.  Each
+   page is faulted in and pinned before the file's locks are
+   taken and is accessed through its kernel alias, so the copy
+   never faults: a fault there could load a page mapped from F
+   itself and take F's locks a second time.  Sector-aligned
+   transfers on a direct file skip the buffer cache. */
+int
+user_io (struct file *f, void *buffer, unsigned size, off_t offset, bool write)
+{
+  bool direct = file_can_direct (f, buffer, size, offset);
+  uint8_t *upage = buffer;
+  unsigned done = 0;
+
+  while (done < size)
+  {
+    unsigned page_left = PGSIZE - pg_ofs (upage + done);
+    unsigned chunk = size - done < page_left ? size - done : page_left;
+    void *kaddr;
+    off_t _bytes;
+
+    check_vaddr (upage + done);
+    kaddr = frame_pin (upage + done);
+
+    if (kaddr == NULL)
+	sys_exit (ERROR);
+
+    if (!write && !valid_writable_ptr (upage + done))
+    {
+	frame_unpin (upage + done, false);
+	sys_exit (ERROR);
+    }
+
+    if (direct && write)
+	_bytes = file_write_direct (f, kaddr, chunk, offset + done);
+    else if (direct)
+	_bytes = file_read_direct (f, kaddr, chunk, offset + done);
+    else if (write)
+	_bytes = file_write_at (f, kaddr, chunk, offset + done);
+    else
+	_bytes = file_read_at (f, kaddr, chunk, offset + done);
+
+    frame_unpin (upage + done, !write && _bytes > 0);
+    done += _bytes;
+
+    if ((unsigned) _bytes < chunk)
+      break;
+  }
+
+  return done;
+}
+
+// IMTF
+int
+get_dir_entries (struct file *f, off_t *cookie, struct dirent *ents, int cnt)
+{
+  struct inode *inode = file_get_inode (f);
+  struct dir *dir;
+  int n;
+
+  if (!inode_is_dir (inode))
+    return ERROR;
+
+  dir = dir_open (inode_reopen (inode));
+
+  if (dir == NULL)
+    return ERROR;
+
+  file_begin_listing (f);
+  n = dir_read_entries (dir, cookie, ents, cnt);
+  dir_close (dir);
+
+  return n;
+}
+
 // IMTF
 int
 set_file (struct file *f)
@@ -717,3 +1252,12 @@ intf_exit (int status)
 {
   sys_exit (status);
 }
+
+// IMTF
+/* Returns true if SIZE bytes starting at the user-supplied
+   OFFSET all lie at offsets that fit in an off_t. */
+bool
+valid_offset (unsigned offset, unsigned size)
+{
+  return offset <= INT32_MAX && size <= INT32_MAX - offset;
+}
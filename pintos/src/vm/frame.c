@@ -1,17 +1,50 @@
 #include <stdio.h>
+#include <string.h>
+#include <random.h>
 #include "vm/frame.h"
 #include "vm/swap.h"
+#include "vm/vmstat.h"
 #include "userprog/process.h"
 #include "userprog/pagedir.h"
 #include "threads/thread.h"
 #include "threads/palloc.h"
 #include "threads/malloc.h"
 #include "threads/interrupt.h"
+#include "threads/vaddr.h"
 #include "filesys/file.h"
+#include "devices/timer.h"
+
+/* Ticks between two updates of the aging counters. */
+#define AGING_INTERVAL (TIMER_FREQ / 10)
+
+/* Bit set in access_cnt when a frame was accessed recently. */
+#define AGING_MSB 0x80
 
 struct lock frame_lock;
 
+/* Next frame examined by the clock policy. */
+static struct list_elem *clock_hand;
+
 struct frame *find_frame (void *);
+static void remove_frame (struct frame *);
+static struct frame *fifo_select (void);
+static struct frame *clock_select (void);
+static struct frame *aging_select (void);
+static void aging_tick (void);
+static struct frame *random_select (void);
+
+/* Available page replacement policies.  The first one is the
+   default. */
+static const struct evict_policy evict_policies[] =
+  {
+    {"fifo", fifo_select, NULL},
+    {"clock", clock_select, NULL},
+    {"aging", aging_select, aging_tick},
+    {"random", random_select, NULL},
+    {NULL, NULL, NULL},
+  };
+
+static const struct evict_policy *cur_policy = evict_policies;
 
 void
 init_frame_table (void)
@@ -30,7 +63,7 @@ free_frame (void *addr)
 
   if (f != NULL)
   {
-    list_remove (&f->elem);
+    remove_frame (f);
     free (f);
     palloc_free_page (addr);
   }
@@ -50,11 +83,15 @@ set_frame (struct page *pte, bool zero_flag)
   else
     addr = palloc_get_page (PAL_USER);
 
+  /* If every frame is pinned, let their users finish and try
+     again. */
   while (addr == NULL)
   {
     lock_acquire (&frame_lock);
     addr = evict_frame (zero_flag);
     lock_release (&frame_lock);
+    if (addr == NULL)
+      thread_yield ();
   }
 
   f = (struct frame *) malloc (sizeof (struct frame));
@@ -62,6 +99,7 @@ set_frame (struct page *pte, bool zero_flag)
   f->pte = pte;
   f->t = thread_current ();
   f->access_cnt = 0;
+  f->pin_cnt = 0;
   old_level = intr_disable ();
   list_push_back (&frame_table, &f->elem);
   intr_set_level (old_level);
@@ -74,31 +112,39 @@ set_frame (struct page *pte, bool zero_flag)
 void *
 evict_frame (bool zero_flag)
 {
-  struct frame *f = evict_policy ();
+  struct frame *f;
   enum intr_level old_level;
+  struct vmstat_timer evict_timer, wb_timer;
+
+  vmstat_start (&evict_timer);
+  f = cur_policy->select ();
+  if (f == NULL)
+    return NULL;
 
   if (pagedir_is_dirty (f->t->pagedir, f->pte->addr))
   {
+    vmstat_start (&wb_timer);
+
     if (f->pte->type == SEG_MMAP)
-    {
-	lock_acquire (&file_lock);
 	file_write_at (f->pte->f, f->addr, f->pte->read_bytes, f->pte->file_offset);
-	lock_release (&file_lock);
-    }
     else
     {
 	f->pte->is_swap = true;
 	f->pte->swap_offset = set_frame_in_block (f->addr);
+	vmstat_swap_slot (f->t, 1);
     }
+
+    vmstat_stop (&wb_timer, VMSTAT_WRITEBACK);
   }
 
   f->pte->is_load = false;
   pagedir_clear_page (f->t->pagedir, f->pte->addr);
   palloc_free_page (f->addr);
   old_level = intr_disable ();
-  list_remove (&f->elem);
+  remove_frame (f);
   intr_set_level (old_level);
   free (f);
+  vmstat_stop (&evict_timer, VMSTAT_EVICT);
 
   if (zero_flag)
     return palloc_get_page (PAL_USER | PAL_ZERO);
@@ -106,31 +152,108 @@ evict_frame (bool zero_flag)
     return palloc_get_page (PAL_USER);
 }
 
-struct frame *
-evict_policy (void)
+/* Brings the current process's page containing user address
+   UADDR into memory, if it is not there already, and pins its
+   frame so that it is not evicted until frame_unpin() is called.
+   Returns the kernel address that aliases UADDR, through which
+   the kernel may access the page without faulting, or a null
+   pointer if UADDR is not mapped. */
+void *
+frame_pin (const void *uaddr)
 {
-  /*struct list_elem *e = list_begin (&frame_table);
-  struct frame *f = list_entry (e, struct frame, elem);
-  enum intr_level old_level = intr_disable ();
+  struct thread *cur = thread_current ();
+  void *upage = pg_round_down (uaddr);
 
-  while (!is_from_user_pool (f->addr))
+  for (;;)
   {
-    e = list_next (e);
-    list_remove (&f->elem);
-    list_push_back (&frame_table, &f->elem);
-    f = list_entry (e, struct frame, elem);
+    struct page *p;
+    uint8_t *kpage;
+    bool loaded;
+
+    /* Evictions hold frame_lock throughout, so a page found
+       present here stays present once pinned. */
+    lock_acquire (&frame_lock);
+    kpage = pagedir_get_page (cur->pagedir, upage);
+    if (kpage != NULL)
+    {
+      enum intr_level old_level = intr_disable ();
+      struct frame *f = find_frame (kpage);
+
+      if (f != NULL)
+	f->pin_cnt++;
+      intr_set_level (old_level);
+      lock_release (&frame_lock);
+      return kpage + pg_ofs (uaddr);
+    }
+    lock_release (&frame_lock);
+
+    p = page_lookup (upage);
+    if (p == NULL)
+      return NULL;
+    loaded = p->type == SEG_STACK ? stack_growth (p->addr) : lazy_loading (p);
+    if (!loaded)
+      return NULL;
   }
+}
+
+/* Unpins the frame holding user address UADDR, pinned by
+   frame_pin().  If DIRTY is true, marks the page dirty, since
+   writes through the kernel alias do not set its dirty bit. */
+void
+frame_unpin (const void *uaddr, bool dirty)
+{
+  struct thread *cur = thread_current ();
+  void *kpage = pagedir_get_page (cur->pagedir, uaddr);
+  enum intr_level old_level;
+  struct frame *f;
 
+  if (kpage == NULL)
+    return;
+  if (dirty)
+    pagedir_set_dirty (cur->pagedir, uaddr, true);
+
+  old_level = intr_disable ();
+  f = find_frame (pg_round_down (kpage));
+  if (f != NULL)
+    f->pin_cnt--;
   intr_set_level (old_level);
+}
+
+/* Selects the page replacement policy named NAME.
+   Returns false if there is no such policy. */
+bool
+set_evict_policy (const char *name)
+{
+  const struct evict_policy *p;
 
-  return f;*/
+  for (p = evict_policies; p->name != NULL; p++)
+    if (!strcmp (name, p->name))
+    {
+	cur_policy = p;
+	return true;
+    }
 
+  return false;
+}
 
-  struct list_elem *e = list_begin (&frame_table);
+/* Returns the name of the page replacement policy in use. */
+const char *
+get_evict_policy (void)
+{
+  return cur_policy->name;
+}
 
-  return list_entry (e, struct frame, elem);
+/* Called by the timer interrupt handler on every tick. */
+void
+frame_table_tick (void)
+{
+  if (cur_policy->tick != NULL)
+    cur_policy->tick ();
 }
 
+/* Ages every frame's access count: shifts it right by one and
+   sets the top bit if the page was accessed since the last
+   call. */
 void
 check_frame_accessed_recently (void)
 {
@@ -141,10 +264,11 @@ check_frame_accessed_recently (void)
   for (e = list_begin (&frame_table); e != list_end (&frame_table); e = list_next (e))
   {
     f = list_entry (e, struct frame, elem);
+    f->access_cnt >>= 1;
 
     if (pagedir_is_accessed (f->t->pagedir, f->pte->addr))
     {
-	f->access_cnt++;
+	f->access_cnt |= AGING_MSB;
 	pagedir_set_accessed (f->t->pagedir, f->pte->addr, false);
     }
   }
@@ -154,40 +278,156 @@ check_frame_accessed_recently (void)
   return;
 }
 
-void
-sort_frame_table (void)
+struct frame *
+find_frame (void *addr)
+{
+  struct frame *f;
+  struct list_elem *e;
+
+  for (e = list_begin (&frame_table); e != list_end (&frame_table); e = list_next (e))
+  {
+    f = list_entry (e, struct frame, elem);
+
+    if (addr == f->addr)
+	return f;
+  }
+
+  return NULL;
+}
+
+/* Removes F from the frame table, moving the clock hand off it
+   first.  Interrupts must be off. */
+static void
+remove_frame (struct frame *f)
+{
+  if (clock_hand == &f->elem)
+    clock_hand = list_next (clock_hand);
+
+  list_remove (&f->elem);
+}
+
+/* First in, first out: evicts the frame that was allocated
+   longest ago.  Pinned frames are passed over by every policy,
+   which returns a null pointer if every frame is pinned. */
+static struct frame *
+fifo_select (void)
 {
+  struct frame *f = NULL;
+  struct list_elem *e;
   enum intr_level old_level = intr_disable ();
 
-//print_all_list ();
-  list_sort (&frame_table, check_access_cnt, NULL);
+  for (e = list_begin (&frame_table); e != list_end (&frame_table); e = list_next (e))
+    if (list_entry (e, struct frame, elem)->pin_cnt == 0)
+    {
+      f = list_entry (e, struct frame, elem);
+      break;
+    }
+
   intr_set_level (old_level);
 
-  return;
+  return f;
 }
 
-struct frame *
-find_frame (void *addr)
+/* Second chance: sweeps the frame table like a clock hand,
+   clearing accessed bits, and evicts the first frame whose page
+   has not been accessed since the last sweep. */
+static struct frame *
+clock_select (void)
 {
-  struct frame *f;
+  struct frame *f = NULL;
+  size_t i, limit;
+  enum intr_level old_level = intr_disable ();
+
+  /* Two sweeps find an unpinned frame if there is one: the first
+     clears every accessed bit that could stop the second. */
+  limit = 2 * list_size (&frame_table);
+  for (i = 0; i < limit; i++)
+  {
+    struct frame *cand;
+
+    if (clock_hand == NULL || clock_hand == list_end (&frame_table))
+      clock_hand = list_begin (&frame_table);
+
+    cand = list_entry (clock_hand, struct frame, elem);
+    clock_hand = list_next (clock_hand);
+
+    if (cand->pin_cnt > 0)
+      continue;
+    if (!pagedir_is_accessed (cand->t->pagedir, cand->pte->addr))
+    {
+      f = cand;
+      break;
+    }
+
+    pagedir_set_accessed (cand->t->pagedir, cand->pte->addr, false);
+  }
+
+  intr_set_level (old_level);
+
+  return f;
+}
+
+/* Aging: evicts the frame with the smallest access count, as
+   maintained by check_frame_accessed_recently().  Ties go to the
+   oldest frame.  Returns a null pointer if every frame is
+   pinned. */
+static struct frame *
+aging_select (void)
+{
+  struct frame *f, *victim = NULL;
   struct list_elem *e;
+  enum intr_level old_level = intr_disable ();
 
   for (e = list_begin (&frame_table); e != list_end (&frame_table); e = list_next (e))
   {
     f = list_entry (e, struct frame, elem);
 
-    if (addr == f->addr)
-	return f;
+    if (f->pin_cnt > 0)
+      continue;
+    if (victim == NULL || f->access_cnt < victim->access_cnt)
+      victim = f;
   }
 
-  return NULL;
+  intr_set_level (old_level);
+
+  return victim;
 }
 
-bool
-check_access_cnt (const struct list_elem *e1, const struct list_elem *e2, void *aux UNUSED)
+static void
+aging_tick (void)
+{
+  if (timer_ticks () % AGING_INTERVAL == 0)
+    check_frame_accessed_recently ();
+}
+
+/* Evicts a frame chosen uniformly at random. */
+static struct frame *
+random_select (void)
 {
-  struct frame *f1 = list_entry (e1, struct frame, elem);
-  struct frame *f2 = list_entry (e2, struct frame, elem);
+  struct frame *f = NULL;
+  struct list_elem *e;
+  size_t i, unpinned = 0;
+  enum intr_level old_level = intr_disable ();
+
+  /* Pick among the unpinned frames only, so that the choice is
+     made in one pass and a fully pinned table yields nothing. */
+  for (e = list_begin (&frame_table); e != list_end (&frame_table); e = list_next (e))
+    if (list_entry (e, struct frame, elem)->pin_cnt == 0)
+      unpinned++;
+
+  if (unpinned > 0)
+  {
+    i = random_ulong () % unpinned;
+    for (e = list_begin (&frame_table); f == NULL; e = list_next (e))
+    {
+      struct frame *cand = list_entry (e, struct frame, elem);
+
+      if (cand->pin_cnt == 0 && i-- == 0)
+	f = cand;
+    }
+  }
+
+  intr_set_level (old_level);
 
-  return f1->access_cnt < f2->access_cnt;
+  return f;
 }
@@ -12,16 +12,27 @@ struct frame
     struct page *pte;
     struct thread *t;
     int access_cnt;
+    int pin_cnt;                        /* Pins against eviction. */
     struct list_elem elem;
   };
 
+/* A page replacement policy, selected with the -evict option. */
+struct evict_policy
+  {
+    const char *name;                   /* Name used on the command line. */
+    struct frame *(*select) (void);     /* Chooses the frame to evict, or null. */
+    void (*tick) (void);                /* Timer hook, may be null. */
+  };
+
 void init_frame_table (void);
 void free_frame (void *);
 void *set_frame (struct page *, bool zero_flag);
 void *evict_frame (bool zero_flag);
-struct frame *evict_policy (void);
+bool set_evict_policy (const char *name);
+const char *get_evict_policy (void);
+void frame_table_tick (void);
 void check_frame_accessed_recently (void);
-void sort_frame_table (void);
-bool check_access_cnt (const struct list_elem *, const struct list_elem *, void * UNUSED);
+void *frame_pin (const void *uaddr);
+void frame_unpin (const void *uaddr, bool dirty);
 
 #endif /* vm/frame.h */
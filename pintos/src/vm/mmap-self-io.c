@@ -0,0 +1,57 @@
+/* Uses not-yet-loaded pages of a file's own mapping as the buffer
+   for write() and read() calls on that file.  Loading such a page
+   reads the file, so the kernel must fault the buffer in before
+   it takes the file's locks, or the calls deadlock. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define ACTUAL ((void *) 0x10000000)
+#define PAGE_SIZE 4096
+
+static char buf[PAGE_SIZE * 2];
+static char check[PAGE_SIZE * 2];
+
+void
+test_main (void)
+{
+  int handle;
+  mapid_t map;
+  size_t i;
+
+  for (i = 0; i < sizeof buf; i++)
+    buf[i] = i % 251;
+
+  CHECK (create ("self", 0), "create \"self\"");
+  CHECK ((handle = open ("self")) > 1, "open \"self\"");
+  CHECK (write (handle, buf, sizeof buf) == sizeof buf,
+         "write \"self\"");
+  CHECK ((map = mmap (handle, ACTUAL)) != MAP_FAILED, "mmap \"self\"");
+
+  /* Append the mapped data to the file it is mapped from. */
+  CHECK (write (handle, ACTUAL, sizeof buf) == sizeof buf,
+         "write mapped data to \"self\"");
+
+  munmap (map);
+
+  /* Read part of the appended copy back into a fresh mapping.  It
+     is the same data, so writing the mapping back leaves the file
+     as it was. */
+  CHECK ((map = mmap (handle, ACTUAL)) != MAP_FAILED, "mmap \"self\" again");
+  CHECK (pread (handle, (char *) ACTUAL + 100, PAGE_SIZE,
+                sizeof buf + 100) == PAGE_SIZE,
+         "read \"self\" into its mapping");
+  munmap (map);
+
+  CHECK (pread (handle, check, sizeof check, sizeof buf) == sizeof check,
+         "read appended data");
+  CHECK (!memcmp (check, buf, sizeof buf),
+         "compare appended data against written data");
+  CHECK (pread (handle, check, sizeof check, 0) == sizeof check,
+         "read mapped data");
+  CHECK (!memcmp (check, buf, sizeof buf),
+         "compare mapped data against written data");
+  close (handle);
+}
@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-self-io) begin
+(mmap-self-io) create "self"
+(mmap-self-io) open "self"
+(mmap-self-io) write "self"
+(mmap-self-io) mmap "self"
+(mmap-self-io) write mapped data to "self"
+(mmap-self-io) mmap "self" again
+(mmap-self-io) read "self" into its mapping
+(mmap-self-io) read appended data
+(mmap-self-io) compare appended data against written data
+(mmap-self-io) read mapped data
+(mmap-self-io) compare mapped data against written data
+(mmap-self-io) end
+EOF
+pass;
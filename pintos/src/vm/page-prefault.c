@@ -0,0 +1,37 @@
+/* Runs child-linear once lazily and once with prefaulting, and
+   verifies that only the second run loads pages at exec. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Returns the number of pages prefaulted system-wide so far. */
+static unsigned long long
+prefault_cnt (void)
+{
+  struct vmstat st;
+
+  CHECK (vmstat (&st, true), "read global statistics");
+  return st.events[VMSTAT_PREFAULT].cnt;
+}
+
+void
+test_main (void)
+{
+  unsigned long long before;
+  pid_t child;
+
+  before = prefault_cnt ();
+  CHECK ((child = exec_mode ("child-linear", EXEC_LAZY)) != -1,
+         "exec \"child-linear\" lazily");
+  CHECK (wait (child) == 0x42, "wait for child");
+  if (prefault_cnt () != before)
+    fail ("lazy exec prefaulted %llu pages", prefault_cnt () - before);
+
+  before = prefault_cnt ();
+  CHECK ((child = exec_mode ("child-linear", EXEC_PREFAULT)) != -1,
+         "exec \"child-linear\" with prefaulting");
+  CHECK (wait (child) == 0x42, "wait for child");
+  if (prefault_cnt () == before)
+    fail ("prefaulting exec loaded no pages");
+}
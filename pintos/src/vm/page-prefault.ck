@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-prefault) begin
+(page-prefault) read global statistics
+(page-prefault) exec "child-linear" lazily
+(page-prefault) wait for child
+(page-prefault) read global statistics
+(page-prefault) read global statistics
+(page-prefault) exec "child-linear" with prefaulting
+(page-prefault) wait for child
+(page-prefault) read global statistics
+(page-prefault) end
+EOF
+pass;
@@ -0,0 +1,35 @@
+/* Touches a zero-initialized array one page at a time and
+   verifies that vmstat() accounts for the resulting faults. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_CNT 16
+
+static char buf[PAGE_CNT * 4096];
+
+void
+test_main (void)
+{
+  struct vmstat before, after;
+  unsigned long long faults;
+  size_t i;
+
+  CHECK (vmstat (&before, false), "read process statistics");
+  for (i = 0; i < sizeof buf; i += 4096)
+    buf[i] = 1;
+  CHECK (vmstat (&after, false), "read process statistics again");
+
+  /* The first page of BUF may share a page with initialized
+     data, so it is not necessarily a minor fault. */
+  faults = (after.events[VMSTAT_MINOR].cnt
+            - before.events[VMSTAT_MINOR].cnt);
+  if (faults < PAGE_CNT - 1)
+    fail ("%llu minor faults for %d pages", faults, PAGE_CNT);
+
+  CHECK (vmstat (&after, true), "read global statistics");
+  if (after.events[VMSTAT_MINOR].cnt < faults)
+    fail ("global count %llu is less than process count %llu",
+          after.events[VMSTAT_MINOR].cnt, faults);
+}
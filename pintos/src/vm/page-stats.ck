@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(page-stats) begin
+(page-stats) read process statistics
+(page-stats) read process statistics again
+(page-stats) read global statistics
+(page-stats) end
+EOF
+pass;
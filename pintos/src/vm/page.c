@@ -3,6 +3,7 @@
 #include "vm/page.h"
 #include "vm/frame.h"
 #include "vm/swap.h"
+#include "vm/vmstat.h"
 #include "threads/thread.h"
 #include "threads/palloc.h"
 #include "threads/vaddr.h"
@@ -58,6 +59,11 @@ page_action (struct hash_elem *p_, void *aux UNUSED)
     free_frame (pagedir_get_page (t->pagedir, p->addr));
     pagedir_clear_page (t->pagedir, p->addr);
   }
+  else if (p->is_swap)
+  {
+    free_frame_in_block (p->swap_offset);
+    vmstat_swap_slot (t, -1);
+  }
 
   free (p);
 }
@@ -82,20 +88,34 @@ set_page_table_entry (void *addr, seg_type type, struct file *file, off_t ofs, s
 bool
 lazy_loading (struct page *pte)
 {
+  struct vmstat_timer timer;
+  enum vmstat_event event;
+  bool success;
+
 //printf ("lazy_loading1\n");
   if (pte->is_load)
     return false;
 
+  vmstat_start (&timer);
 //printf ("lazy_loading2\n");
   //if (pte->type != SEG_STACK)
   //{
   if (pte->is_swap)
-    return swap_in (pte);
+  {
+    event = VMSTAT_SWAP_IN;
+    success = swap_in (pte);
+  }
   else
-    return load_seg (pte);
+  {
+    event = pte->read_bytes == 0 ? VMSTAT_MINOR : VMSTAT_FILE_LOAD;
+    success = load_seg (pte);
+  }
   //}
 
-  return false;
+  if (success)
+    vmstat_stop (&timer, event);
+
+  return success;
 }
 
 bool
@@ -104,6 +124,7 @@ stack_growth (void *addr)
   struct page *pte = page_lookup (pg_round_up (addr));
   void *frame_addr;
   bool recursive_fin = false;
+  struct vmstat_timer timer;
 
   if (pte == NULL)
   {
@@ -117,6 +138,7 @@ stack_growth (void *addr)
   if (pte->type != SEG_STACK)
     return false;
 
+  vmstat_start (&timer);
 //printf ("0\n");
   if (!set_page_table_entry (pg_round_down (addr), SEG_STACK, NULL, 0, 0))
     return false;
@@ -134,6 +156,31 @@ stack_growth (void *addr)
     return false;
   }
 //printf ("2\n");
+  vmstat_stop (&timer, VMSTAT_STACK_GROWTH);
+
+  return true;
+}
+
+/* Loads the file-backed page at ADDR before it is first
+   touched.  Does nothing if the page is already resident, has
+   been swapped out, or is all zeros. */
+bool
+prefault_page (void *addr)
+{
+  struct page *pte = page_lookup (addr);
+  struct vmstat_timer timer;
+
+  if (pte == NULL || pte->is_load || pte->is_swap || pte->read_bytes == 0)
+    return false;
+
+  vmstat_start (&timer);
+  if (!load_seg (pte))
+  {
+    /* Leave the page to be loaded lazily. */
+    pte->is_load = false;
+    return false;
+  }
+  vmstat_stop (&timer, VMSTAT_PREFAULT);
 
   return true;
 }
@@ -199,8 +246,15 @@ swap_in (struct page *pte)
   }
 //printf ("BEFORE GET_FRAME\n");
   get_frame_in_block (pte->addr, pte->swap_offset);
+  vmstat_swap_slot (thread_current (), -1);
   pte->is_load = true;
 
+  /* The swap slot is free again, so the only copy of the page is
+     now in memory.  Mark it dirty so that a later eviction writes
+     it back to swap instead of dropping it. */
+  pte->is_swap = false;
+  pagedir_set_dirty (thread_current ()->pagedir, pte->addr, true);
+
 //printf ("FIN swap_in\n");
   return true;
 }
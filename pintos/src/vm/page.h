@@ -33,6 +33,7 @@ void free_page_table (struct hash *);
 bool set_page_table_entry (void *, seg_type type, struct file *, off_t ofs, size_t read_bytes);
 bool lazy_loading (struct page *);
 bool stack_growth (void *);
+bool prefault_page (void *);
 struct page *page_lookup (void *);
 
 #endif /* vm/page.h */
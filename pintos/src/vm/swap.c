@@ -1,56 +1,191 @@
 #include <stdio.h>
+#include <string.h>
+#include <bitmap.h>
 #include "vm/swap.h"
+#include "vm/vmstat.h"
+#include "devices/block.h"
 #include "threads/vaddr.h"
 #include "threads/interrupt.h"
 #include "threads/synch.h"
 
 #define SECTOR_OFFSET (PGSIZE / BLOCK_SECTOR_SIZE)
 
+/* A swap device.  Page slots are striped across all of them, so
+   a slot number encodes both the device and the page slot on
+   it: slot = page * SWAP_DEV_MAX + device index. */
+struct swap_dev
+  {
+    struct block *block;        /* Underlying block device. */
+    struct bitmap *bitmap;      /* In-use page slots. */
+    size_t free_cnt;            /* Number of free page slots. */
+    int pending;                /* Transfers in progress. */
+  };
+
+static struct swap_dev swap_devs[SWAP_DEV_MAX];
+static int swap_dev_cnt;
+
+/* Device tried first when queue depths are equal. */
+static int next_dev;
+
+/* Protects the bitmaps, pending counts and next_dev.  Not held
+   during I/O, so that devices on different IDE channels can
+   transfer at the same time. */
 struct lock swap_lock;
 //int temp = 0;
 
+static void add_swap_dev (struct block *);
+static struct swap_dev *choose_swap_dev (void);
+
+/* Registers the swap devices.  NAMES is a comma-separated list
+   of block device names, or a null pointer to use every block
+   device of type BLOCK_SWAP in probe order. */
 void
-init_swap (void)
+init_swap (const char *names)
 {
-  swap_block = block_get_role (BLOCK_SWAP);
-  swap_bitmap = bitmap_create (block_size (swap_block) / SECTOR_OFFSET);
-  bitmap_set_all (swap_bitmap, 0);
+  struct block *block;
+  size_t total = 0;
+  int i;
+
   lock_init (&swap_lock);
+
+  if (names != NULL)
+  {
+    char buf[64];
+    char *name, *save_ptr;
+
+    strlcpy (buf, names, sizeof buf);
+    for (name = strtok_r (buf, ",", &save_ptr); name != NULL;
+         name = strtok_r (NULL, ",", &save_ptr))
+    {
+	block = block_get_by_name (name);
+	if (block == NULL)
+	  PANIC ("No such block device \"%s\"", name);
+	add_swap_dev (block);
+    }
+  }
+  else
+  {
+    for (block = block_first (); block != NULL; block = block_next (block))
+      if (block_type (block) == BLOCK_SWAP)
+	add_swap_dev (block);
+  }
+
+  if (swap_dev_cnt > 0)
+    block_set_role (BLOCK_SWAP, swap_devs[0].block);
+
+  for (i = 0; i < swap_dev_cnt; i++)
+    total += bitmap_size (swap_devs[i].bitmap);
+  vmstat_set_swap_total (total);
 //printf ("block cnt : %d\n", block_size (swap_block) / SECTOR_OFFSET);
 }
 
 size_t
 set_frame_in_block (void *addr)
 {
-  size_t map_offset, i;
-  //enum intr_level old_level = intr_disable ();
+  struct swap_dev *d;
+  size_t page, i;
+
   lock_acquire (&swap_lock);
-  map_offset = bitmap_scan_and_flip (swap_bitmap, 0, 1, 0);
-  //lock_release (&swap_lock);
+  d = choose_swap_dev ();
+  if (d == NULL)
+    PANIC ("out of swap space");
+  page = bitmap_scan_and_flip (d->bitmap, 0, 1, false);
+  d->free_cnt--;
+  d->pending++;
+  lock_release (&swap_lock);
 
   for (i = 0; i < SECTOR_OFFSET; i++)
-    block_write (swap_block, (SECTOR_OFFSET * map_offset) + i, addr + (BLOCK_SECTOR_SIZE * i));
+    block_write (d->block, (SECTOR_OFFSET * page) + i, addr + (BLOCK_SECTOR_SIZE * i));
 
+  lock_acquire (&swap_lock);
+  d->pending--;
   lock_release (&swap_lock);
-  //intr_set_level (old_level);
 //temp++;
 //printf ("temp : %d\n", temp);
 
-  return map_offset;
+  return page * SWAP_DEV_MAX + (d - swap_devs);
 }
 
 void
 get_frame_in_block (void *addr, size_t map_offset)
 {
+  struct swap_dev *d = &swap_devs[map_offset % SWAP_DEV_MAX];
+  size_t page = map_offset / SWAP_DEV_MAX;
   size_t i;
-  //enum intr_level old_level = intr_disable ();
+
   lock_acquire (&swap_lock);
-  bitmap_flip (swap_bitmap, map_offset);
-  //lock_release (&swap_lock);
+  d->pending++;
+  lock_release (&swap_lock);
 
+  /* The slot stays allocated until the read is done, so that it
+     cannot be handed out and overwritten under us. */
   for (i = 0; i < SECTOR_OFFSET; i++)
-    block_read (swap_block, (SECTOR_OFFSET * map_offset) + i, addr + (BLOCK_SECTOR_SIZE * i));
+    block_read (d->block, (SECTOR_OFFSET * page) + i, addr + (BLOCK_SECTOR_SIZE * i));
 
+  lock_acquire (&swap_lock);
+  d->pending--;
+  bitmap_reset (d->bitmap, page);
+  d->free_cnt++;
   lock_release (&swap_lock);
-  //intr_set_level (old_level);
+}
+
+void
+free_frame_in_block (size_t map_offset)
+{
+  struct swap_dev *d = &swap_devs[map_offset % SWAP_DEV_MAX];
+
+  lock_acquire (&swap_lock);
+  bitmap_reset (d->bitmap, map_offset / SWAP_DEV_MAX);
+  d->free_cnt++;
+  lock_release (&swap_lock);
+}
+
+/* Adds BLOCK to the set of swap devices. */
+static void
+add_swap_dev (struct block *block)
+{
+  struct swap_dev *d;
+
+  if (swap_dev_cnt >= SWAP_DEV_MAX)
+  {
+    printf ("swap: ignoring %s, too many swap devices\n", block_name (block));
+    return;
+  }
+
+  d = &swap_devs[swap_dev_cnt++];
+  d->block = block;
+  d->bitmap = bitmap_create (block_size (block) / SECTOR_OFFSET);
+  if (d->bitmap == NULL)
+    PANIC ("swap bitmap creation failed");
+  d->free_cnt = bitmap_size (d->bitmap);
+  d->pending = 0;
+  printf ("swap: using %s\n", block_name (block));
+}
+
+/* Returns the swap device that should get the next page: the one
+   with the fewest transfers in progress that still has a free
+   slot, starting from next_dev so that idle devices are used in
+   turn.  Returns a null pointer if every device is full.
+   swap_lock must be held. */
+static struct swap_dev *
+choose_swap_dev (void)
+{
+  struct swap_dev *best = NULL;
+  int i;
+
+  for (i = 0; i < swap_dev_cnt; i++)
+  {
+    struct swap_dev *d = &swap_devs[(next_dev + i) % swap_dev_cnt];
+
+    if (d->free_cnt == 0)
+      continue;
+
+    if (best == NULL || d->pending < best->pending)
+      best = d;
+  }
+
+  if (best != NULL)
+    next_dev = (best - swap_devs + 1) % swap_dev_cnt;
+
+  return best;
 }
@@ -1,14 +1,14 @@
 #ifndef VM_SWAP_H
 #define VM_SWAP_H
 
-#include <bitmap.h>
-#include "devices/block.h"
+#include <stddef.h>
 
-struct block *swap_block;
-struct bitmap *swap_bitmap;
+/* Maximum number of swap devices that pages are striped over. */
+#define SWAP_DEV_MAX 4
 
-void init_swap (void);
+void init_swap (const char *names);
 size_t set_frame_in_block (void *);
 void get_frame_in_block (void *, size_t map_offset);
+void free_frame_in_block (size_t map_offset);
 
 #endif /* vm/swap.h */
@@ -0,0 +1,163 @@
+#include <stdio.h>
+#include "vm/vmstat.h"
+#include "vm/frame.h"
+#include "devices/timer.h"
+#include "threads/thread.h"
+#include "threads/interrupt.h"
+#include "userprog/process.h"
+
+/* System-wide statistics. */
+static struct vmstat global_stat;
+
+static const char *event_names[VMSTAT_EVENT_CNT] =
+  {
+    "minor faults",
+    "file loads",
+    "swap-ins",
+    "stack growths",
+    "evictions",
+    "write-backs",
+    "prefaults",
+  };
+
+static void count_event (struct vmstat *, enum vmstat_event,
+                         int64_t ticks, uint64_t cycles);
+static void count_swap_slot (struct vmstat *, int delta);
+
+/* Reads the CPU's time-stamp counter. */
+static inline uint64_t
+rdtsc (void)
+{
+  uint64_t tsc;
+  asm volatile ("rdtsc" : "=A" (tsc));
+  return tsc;
+}
+
+/* Records the start of an event in T. */
+void
+vmstat_start (struct vmstat_timer *t)
+{
+  t->ticks = timer_ticks ();
+  t->tsc = rdtsc ();
+}
+
+/* Records the end of an event of kind EVENT that started at T,
+   charging it to the current process and to the global totals. */
+void
+vmstat_stop (struct vmstat_timer *t, enum vmstat_event event)
+{
+  uint64_t cycles = rdtsc () - t->tsc;
+  int64_t ticks = timer_elapsed (t->ticks);
+  struct thread *cur = thread_current ();
+  enum intr_level old_level = intr_disable ();
+
+  count_event (&global_stat, event, ticks, cycles);
+  if (cur->pcb != NULL)
+    count_event (&cur->pcb->vmstat, event, ticks, cycles);
+
+  intr_set_level (old_level);
+}
+
+/* Sets the number of swap slots available system-wide. */
+void
+vmstat_set_swap_total (unsigned slots)
+{
+  global_stat.swap_slots_total = slots;
+}
+
+/* Adds DELTA to the number of swap slots held by T's process. */
+void
+vmstat_swap_slot (struct thread *t, int delta)
+{
+  enum intr_level old_level = intr_disable ();
+
+  count_swap_slot (&global_stat, delta);
+  if (t->pcb != NULL)
+    count_swap_slot (&t->pcb->vmstat, delta);
+
+  intr_set_level (old_level);
+}
+
+/* Copies the global statistics into *ST if GLOBAL is true,
+   otherwise those of the current process. */
+void
+vmstat_get (struct vmstat *st, bool global)
+{
+  struct thread *cur = thread_current ();
+  enum intr_level old_level = intr_disable ();
+
+  if (global || cur->pcb == NULL)
+    *st = global_stat;
+  else
+  {
+    *st = cur->pcb->vmstat;
+    st->swap_slots_total = global_stat.swap_slots_total;
+  }
+
+  intr_set_level (old_level);
+}
+
+/* Prints the global VM statistics. */
+void
+vmstat_print_stats (void)
+{
+  int i, j;
+
+  printf ("VM: %s page replacement\n", get_evict_policy ());
+  for (i = 0; i < VMSTAT_EVENT_CNT; i++)
+  {
+    const struct vmstat_counter *c = &global_stat.events[i];
+
+    printf ("VM: %llu %s, %llu ticks, %llu cycles avg, %llu cycles max\n",
+            c->cnt, event_names[i], c->ticks,
+            c->cnt > 0 ? c->cycles / c->cnt : 0, c->max_cycles);
+
+    if (c->cnt > 0)
+    {
+	printf ("VM:   histogram:");
+	for (j = 0; j < VMSTAT_HIST_CNT; j++)
+	  printf (" %llu", c->hist[j]);
+	printf ("\n");
+    }
+  }
+  printf ("VM: %u swap slots in use, %u peak, %u total\n",
+          global_stat.swap_slots, global_stat.swap_slots_peak,
+          global_stat.swap_slots_total);
+}
+
+/* Adds one EVENT that took TICKS timer ticks and CYCLES TSC
+   cycles to ST. */
+static void
+count_event (struct vmstat *st, enum vmstat_event event,
+             int64_t ticks, uint64_t cycles)
+{
+  struct vmstat_counter *c = &st->events[event];
+  uint64_t limit = VMSTAT_HIST_BASE;
+  int bucket = 0;
+
+  while (bucket < VMSTAT_HIST_CNT - 1 && cycles >= limit)
+  {
+    limit <<= 2;
+    bucket++;
+  }
+
+  c->cnt++;
+  c->ticks += ticks;
+  c->cycles += cycles;
+  if (cycles > c->max_cycles)
+    c->max_cycles = cycles;
+  c->hist[bucket]++;
+}
+
+/* Adds DELTA to ST's swap slot count and updates its peak. */
+static void
+count_swap_slot (struct vmstat *st, int delta)
+{
+  if (delta < 0 && st->swap_slots < (unsigned) -delta)
+    st->swap_slots = 0;
+  else
+    st->swap_slots += delta;
+
+  if (st->swap_slots > st->swap_slots_peak)
+    st->swap_slots_peak = st->swap_slots;
+}
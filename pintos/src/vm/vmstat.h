@@ -0,0 +1,24 @@
+#ifndef VM_VMSTAT_H
+#define VM_VMSTAT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <vmstat.h>
+
+struct thread;
+
+/* Start time of an event being measured. */
+struct vmstat_timer
+  {
+    int64_t ticks;
+    uint64_t tsc;
+  };
+
+void vmstat_start (struct vmstat_timer *);
+void vmstat_stop (struct vmstat_timer *, enum vmstat_event);
+void vmstat_set_swap_total (unsigned slots);
+void vmstat_swap_slot (struct thread *, int delta);
+void vmstat_get (struct vmstat *, bool global);
+void vmstat_print_stats (void);
+
+#endif /* vm/vmstat.h */